@@ -5,6 +5,7 @@
 // Root includes
 #include <THnSparse.h>
 #include <TPad.h>
+#include <TMath.h>
 
 // Own includes
 #include "TrackPairEfficiencyHistogramManager.h"
@@ -558,6 +559,12 @@ void TrackPairEfficiencyHistogramManager::LoadTrackPairHistograms(){
   for(int iDataLevel = 0; iDataLevel < TrackPairEfficiencyHistograms::knDataLevels; iDataLevel++){
     if(!fLoadTrackPairs[iDataLevel]) continue;  // Only load the selected track pair types
     
+    // If the analysis filled the pairs directly in DeltaR slices, there is no THnSparse to project from
+    if(IsPreSliced(iDataLevel)){
+      LoadTrackPairSlices(iDataLevel);
+      continue;
+    }
+    
     // Find the histogram array from which the projections are made
     THnSparseD *histogramArray = (THnSparseD*) fInputFile->Get(fTrackPairHistogramNames[iDataLevel]);
     
@@ -616,6 +623,159 @@ void TrackPairEfficiencyHistogramManager::LoadTrackPairHistograms(){
   } // Data level loop
 }
 
+/*
+ * Check if the track pairs are written in DeltaR slices by the analysis instead of a THnSparse.
+ * This is the case when the analysis is run with FillDeltaRSlices 1.
+ *
+ *  Arguments:
+ *   const int iDataLevel = Reconstructed tracks or generator level particles
+ *
+ *   return: True if the track pair histograms are in a directory of DeltaR slices
+ */
+bool TrackPairEfficiencyHistogramManager::IsPreSliced(const int iDataLevel) const{
+  return (fInputFile->GetDirectory(fTrackPairHistogramNames[iDataLevel]) != NULL);
+}
+
+/*
+ * Name of the histogram from which the track pair bin indices are found. For pairs written in DeltaR slices,
+ * this is the empty THnSparse with the binning of the slices, which is written next to them.
+ *
+ *  Arguments:
+ *   const int iDataLevel = Reconstructed tracks or generator level particles
+ *
+ *   return: Name of the histogram with the track pair binning
+ */
+const char* TrackPairEfficiencyHistogramManager::GetTrackPairBinningName(const int iDataLevel) const{
+  if(IsPreSliced(iDataLevel)) return fTrackPairBinningNames[iDataLevel];
+  return fTrackPairHistogramNames[iDataLevel];
+}
+
+/*
+ * Loader for track pair histograms filled directly in DeltaR slices by the analysis
+ *
+ *   Directory name: trackPairs/genParticlePairs
+ *
+ *   The slices are named <pairs>DeltaR_C%dT%dA%d(E%d), where the indices are the bins of the analysis.
+ *   The binning of the slices is in the empty THnSparse <pairs>Binning with the same axes as the full
+ *   track pair THnSparse. The bin indices are found from it, so the slices in each projected bin are the
+ *   same bins that would be projected from the full THnSparse.
+ *
+ *  Arguments:
+ *   const int iDataLevel = Reconstructed tracks or generator level particles
+ */
+void TrackPairEfficiencyHistogramManager::LoadTrackPairSlices(const int iDataLevel){
+  
+  // Define arrays for the bin ranges. The order is centrality, trigger pT, associated pT and average eta.
+  int lowLimits[4] = {0};
+  int highLimits[4] = {0};
+  
+  // Define helper variables
+  int duplicateRemover = -1;
+  
+  // Centrality loop
+  for(int iCentrality = fFirstLoadedCentralityBin; iCentrality <= fLastLoadedCentralityBin; iCentrality++){
+    
+    // Select the bin indices
+    lowLimits[0] = fCentralityBinIndices[iCentrality];
+    highLimits[0] = fCentralityBinIndices[iCentrality+1]+duplicateRemover;
+    
+    // Trigger pT loop
+    for(int iTriggerPt = fFirstLoadedTrackPairPtBin; iTriggerPt <= fLastLoadedTrackPairPtBin; iTriggerPt++){
+      
+      // Select the bin indices for trigger pT
+      lowLimits[1] = fTrackPairPtBinIndices[iTriggerPt];
+      highLimits[1] = fTrackPairPtBinIndices[iTriggerPt+1]+duplicateRemover;
+      
+      // Associated pT loop
+      for(int iAssociatedPt = fFirstLoadedTrackPairPtBin; iAssociatedPt <= iTriggerPt; iAssociatedPt++){
+        
+        // Select the bin indices for associated pT
+        lowLimits[2] = fTrackPairPtBinIndices[iAssociatedPt];
+        highLimits[2] = fTrackPairPtBinIndices[iAssociatedPt+1]+duplicateRemover;
+        
+        for(int iAverageEta = fFirstLoadedAverageEtaBin; iAverageEta <= fLastLoadedAverageEtaBin; iAverageEta++){
+          
+          // The last average eta index is the distribution integrated over eta
+          if(iAverageEta < fnAverageEtaBins){
+            lowLimits[3] = fAverageEtaBinIndices[iAverageEta];
+            highLimits[3] = fAverageEtaBinIndices[iAverageEta+1]+duplicateRemover;
+          }
+          
+          // Sum the deltaR slices in the selected bins
+          fhTrackPairDeltaR[iCentrality][iTriggerPt][iAssociatedPt][iAverageEta][iDataLevel] = SumDeltaRSlices(iDataLevel, lowLimits, highLimits, iAverageEta == fnAverageEtaBins);
+          
+        } // Average eta loop
+      } // Associated pT loop
+    } // Trigger pT loop
+  } // Centrality loop
+}
+
+/*
+ * Sum the DeltaR slices written by the analysis in the given bin ranges. The slices are normalized to the
+ * bin width, so the sum is normalized in the same way as a projection from the full THnSparse.
+ *
+ *  Arguments:
+ *   const int iDataLevel = Reconstructed tracks or generator level particles
+ *   int *lowBinIndex = Lowest included analysis bins for centrality, trigger pT, associated pT and average eta
+ *   int *highBinIndex = Highest included analysis bins for centrality, trigger pT, associated pT and average eta
+ *   const bool integrateEta = True: Use the slices integrated over eta. False: Sum the average eta slices in the given range.
+ *
+ *   return: Sum of the DeltaR slices
+ */
+TH1D* TrackPairEfficiencyHistogramManager::SumDeltaRSlices(const int iDataLevel, int *lowBinIndex, int *highBinIndex, const bool integrateEta){
+  
+  // Axes of the binning histogram in the order of the bin ranges
+  const int sliceAxes[4] = {5, 1, 2, 4};
+  const int nRanges = integrateEta ? 3 : 4;
+  const char* histogramName = fTrackPairHistogramNames[iDataLevel];
+  
+  // The slices exist only for the bins inside the axes, so limit the ranges to those. The bin borders used in
+  // projectTrackPairEfficiencyHistograms.C do not reach the underflow or overflow bins in the projections either.
+  THnSparseD *binningHistogram = (THnSparseD*) fInputFile->Get(fTrackPairBinningNames[iDataLevel]);
+  int firstBin[4], lastBin[4];
+  for(int iRange = 0; iRange < nRanges; iRange++){
+    firstBin[iRange] = TMath::Max(lowBinIndex[iRange], 1);
+    lastBin[iRange] = TMath::Min(highBinIndex[iRange], binningHistogram->GetAxis(sliceAxes[iRange])->GetNbins());
+  }
+  
+  // Create a unique name for the summed histogram in the same way as for the projections
+  TString newName = histogramName;
+  for(int iRange = 0; iRange < nRanges; iRange++){
+    newName.Append(Form("_%d=%d-%d",sliceAxes[iRange],lowBinIndex[iRange],highBinIndex[iRange]));
+  }
+  
+  // Start from an empty histogram with the deltaR binning of the slices
+  TString histogramNamer = Form("%s/%sDeltaR_C0T0A0", histogramName, histogramName);
+  TH1D *summedHistogram = (TH1D*) fInputFile->Get(histogramNamer.Data())->Clone(newName.Data());
+  summedHistogram->Reset();
+  
+  TH1D *deltaRSlice;
+  for(int iCentrality = firstBin[0]; iCentrality <= lastBin[0]; iCentrality++){
+    for(int iTriggerPt = firstBin[1]; iTriggerPt <= lastBin[1]; iTriggerPt++){
+      
+      // The higher pT track is the trigger, so the slices with higher associated pT are never filled and not written
+      for(int iAssociatedPt = firstBin[2]; iAssociatedPt <= TMath::Min(lastBin[2], iTriggerPt); iAssociatedPt++){
+        
+        if(integrateEta){
+          histogramNamer = Form("%s/%sDeltaR_C%dT%dA%d", histogramName, histogramName, iCentrality-1, iTriggerPt-1, iAssociatedPt-1);
+          deltaRSlice = (TH1D*) fInputFile->Get(histogramNamer.Data());
+          summedHistogram->Add(deltaRSlice);
+          continue;
+        }
+        
+        for(int iAverageEta = firstBin[3]; iAverageEta <= lastBin[3]; iAverageEta++){
+          histogramNamer = Form("%s/%sDeltaR_C%dT%dA%dE%d", histogramName, histogramName, iCentrality-1, iTriggerPt-1, iAssociatedPt-1, iAverageEta-1);
+          deltaRSlice = (TH1D*) fInputFile->Get(histogramNamer.Data());
+          summedHistogram->Add(deltaRSlice);
+        }
+        
+      } // Associated pT loop
+    } // Trigger pT loop
+  } // Centrality loop
+  
+  return summedHistogram;
+}
+
 /*
  * Loader for track pair histograms with jet pT binning
  *
@@ -1434,7 +1594,7 @@ void TrackPairEfficiencyHistogramManager::SetTrackPtBins(const bool readBinsFrom
  */
 void TrackPairEfficiencyHistogramManager::SetTrackPairPtBins(const bool readBinsFromFile, const int nBins, const double *binBorders, const bool setIndices){
   
-  SetGenericBins(readBinsFromFile, "trackPairs", 1, fnTrackPairPtBins, fTrackPairPtBinBorders, fTrackPairPtBinIndices, nBins, binBorders, "track pair pT", kMaxTrackPtBins, setIndices);
+  SetGenericBins(readBinsFromFile, GetTrackPairBinningName(TrackPairEfficiencyHistograms::kReconstructed), 1, fnTrackPairPtBins, fTrackPairPtBinBorders, fTrackPairPtBinIndices, nBins, binBorders, "track pair pT", kMaxTrackPtBins, setIndices);
   
 }
 
@@ -1462,7 +1622,7 @@ void TrackPairEfficiencyHistogramManager::SetJetPtBins(const bool readBinsFromFi
  */
 void TrackPairEfficiencyHistogramManager::SetAverageEtaBins(const bool readBinsFromFile, const int nBins, const double *binBorders, const bool setIndices){
   
-  SetGenericBins(readBinsFromFile, "trackPairs", 4, fnAverageEtaBins, fAverageEtaBinBorders, fAverageEtaBinIndices, nBins, binBorders, "average eta", kMaxAverageEtaBins, setIndices);
+  SetGenericBins(readBinsFromFile, GetTrackPairBinningName(TrackPairEfficiencyHistograms::kReconstructed), 4, fnAverageEtaBins, fAverageEtaBinBorders, fAverageEtaBinIndices, nBins, binBorders, "average eta", kMaxAverageEtaBins, setIndices);
   
 }
 
@@ -43,6 +43,7 @@ private:
   // Naming for track pair histograms
   const char* fTrackPairHistogramNames[TrackPairEfficiencyHistograms::knDataLevels] = {"trackPairs", "genParticlePairs"};
   const char* fTrackPairHistogramCloseToJetNames[TrackPairEfficiencyHistograms::knDataLevels] = {"trackPairsCloseToJet", "genParticlePairsCloseToJet"};
+  const char* fTrackPairBinningNames[TrackPairEfficiencyHistograms::knDataLevels] = {"trackPairs/trackPairsBinning", "genParticlePairs/genParticlePairsBinning"}; // Binning of the pairs filled directly in DeltaR slices
   
   // Naming for data levels
   const char* fDataLevelName[TrackPairEfficiencyHistograms::knDataLevels] = {"", "GeneratorLevel"};
@@ -256,6 +257,12 @@ private:
   void LoadTrackPairHistograms(); // Loader for track pair histograms
   void LoadTrackPairHistogramsCloseToJets(); // Loader for track pair histograms close to jets
   
+  // Track pair histograms filled directly in DeltaR slices
+  bool IsPreSliced(const int iDataLevel) const; // Check if the track pairs are written in DeltaR slices instead of a THnSparse
+  const char* GetTrackPairBinningName(const int iDataLevel) const; // Name of the histogram from which the track pair bin indices are found
+  void LoadTrackPairSlices(const int iDataLevel); // Loader for track pair histograms written in DeltaR slices
+  TH1D* SumDeltaRSlices(const int iDataLevel, int *lowBinIndex, int *highBinIndex, const bool integrateEta); // Sum the DeltaR slices in the given bin ranges
+  
   // Generic setter for bin indice and borders
   void SetGenericBins(const bool readBinsFromFile, const char* histogramName, const int iAxis, int nSetBins, double* setBinBorders, int* setBinIndices, const int nBins, const double *binBorders, const char* errorMessage, const int maxBins, const bool setIndices); // Generic bin setter
   
@@ -0,0 +1,368 @@
+// C++ includes
+#include <iostream>   // Input/output stream. Needed for cout.
+#include <stdlib.h>   // Standard utility libraries
+#include <assert.h>   // Standard c++ debugging tool. Terminates the program if expression given evaluates to 0.
+#include <vector>     // C++ vector class
+#include <sstream>    // Libraries for checking boolean input
+#include <string>     // Libraries for checking boolean input
+#include <algorithm>  // Libraries for checking boolean input
+#include <cctype>     // Libraries for checking boolean input
+
+// Includes from Root
+#include <TString.h>
+#include <TFile.h>
+#include <TTree.h>
+
+// Own includes
+#include "src/ForestReader.h"
+#include "src/MappedForestFile.h"
+
+using namespace std;
+
+/*
+ *  Convert string to boolean value
+ */
+bool checkBool(string str) {
+  std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+  std::istringstream is(str);
+  bool b;
+  is >> std::boolalpha >> b;
+  return b;
+}
+
+/*
+ *  Converter from a full forest to a slim forest
+ *
+ *  The slim forest contains only the information used by ForestReader in a single flat tree. Event level
+ *  information is stored as scalars and jets, tracks and generator level particles as variable length arrays.
+ *  Analyzing the slim forest does not need to join the six forest trees, and it can be written with light or
+ *  no compression for fast repeated reading from local disk. The jet collection is chosen at conversion time,
+ *  so the data type, jet type, jet axis and trigger settings must match the card used to analyze the slim forest.
+ *
+ *  If the output file name ends with .mforest, the events are written in the uncompressed mapped format instead.
+ *  The analysis maps such files to memory and reads the data directly from the mapped pages.
+ *
+ *  Command line arguments:
+ *  argv[1] = Input forest file
+ *  argv[2] = Output slim forest file. Use extension .mforest for the mapped format.
+ *  argv[3] = Data type: 0 = pp, 1 = PbPb, 2 = pp MC, 3 = PbPb MC
+ *  argv[4] = Jet type: 0 = Calo jets, 1 = csPF jets, 2 = puPF jets, 3 = Flow subtracted csPF jets
+ *  argv[5] = Jet axis: 0 = Anti-kT, 1 = WTA
+ *  argv[6] = True: Store the jet trigger bit. False: Do not store the jet trigger bit
+ *  argv[7] = ROOT compression setting for the output file (default 0 = no compression)
+ */
+int main(int argc, char **argv) {
+
+  //==== Read arguments =====
+  if ( argc<7 ) {
+    cout<<"+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++"<<endl;
+    cout<<"+ Usage of the macro: " << endl;
+    cout<<"+  "<<argv[0]<<" [inputFileName] [outputFileName] [dataType] [jetType] [jetAxis] [useTrigger] <compression>"<<endl;
+    cout<<"+  inputFileName: Forest file that is converted to slim forest." <<endl;
+    cout<<"+  outputFileName: .root file to which the slim forest is written. With extension .mforest the mapped format is written." <<endl;
+    cout<<"+  dataType: 0 = pp, 1 = PbPb, 2 = pp MC, 3 = PbPb MC." <<endl;
+    cout<<"+  jetType: 0 = Calo jets, 1 = csPF jets, 2 = puPF jets, 3 = Flow subtracted csPF jets." <<endl;
+    cout<<"+  jetAxis: 0 = Anti-kT axis, 1 = WTA axis." <<endl;
+    cout<<"+  useTrigger: True: Store the jet trigger bit. False: Do not store the jet trigger bit." <<endl;
+    cout<<"+  compression: ROOT compression setting for the output. 0 (default) = No compression, 101 = zlib level 1, 404 = LZ4 level 4." <<endl;
+    cout<<"+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++"<<endl;
+    cout << endl << endl;
+    exit(1);
+  }
+
+  // Read the command line arguments
+  TString inputFileName = argv[1];
+  TString outputFileName = argv[2];
+  const int dataType = atoi(argv[3]);
+  const int jetType = atoi(argv[4]);
+  const int jetAxis = atoi(argv[5]);
+  const bool useTrigger = checkBool(argv[6]);
+  int compression = 0;
+  if(argc >= 8) compression = atoi(argv[7]);
+  const bool isMC = (dataType == ForestReader::kPpMC || dataType == ForestReader::kPbPbMC);
+  const bool writeMapped = MappedForestFile::IsMappedForestFile(outputFileName);
+
+  // Open the input forest
+  TFile *inputFile = TFile::Open(inputFileName);
+  if(!inputFile || !inputFile->IsOpen() || inputFile->IsZombie()){
+    cout << "Error! Could not open the file: " << inputFileName.Data() << endl;
+    assert(0);
+  }
+
+  ForestReader *forestReader = new ForestReader(dataType, jetType, jetAxis, useTrigger);
+  forestReader->ReadForestFromFile(inputFile);
+  const int nEvents = forestReader->GetNEvents();
+
+  // Initial sizes of the jet and track buffers. The buffers grow when an event with more objects is found.
+  int jetBufferSize = 64;
+  int trackBufferSize = 2048;
+
+  // Event level information
+  Float_t vz, ptHat, eventWeight;
+  Int_t hiBin, jetFilterBit, primaryVertexFilterBit, beamScrapingFilterBit, hfCoincidenceFilterBit, clusterCompatibilityFilterBit;
+
+  // Jets
+  Int_t nJets, nGenJets;
+  vector<Float_t> jetPt(jetBufferSize), jetPhi(jetBufferSize), jetEta(jetBufferSize), jetRawPt(jetBufferSize), jetMaxTrackPt(jetBufferSize);
+  vector<Float_t> genJetPt(jetBufferSize), genJetPhi(jetBufferSize), genJetEta(jetBufferSize);
+
+  // Tracks
+  Int_t nTracks;
+  vector<Float_t> trackPt(trackBufferSize), trackPtError(trackBufferSize), trackPhi(trackBufferSize), trackEta(trackBufferSize);
+  vector<UChar_t> trackHighPurity(trackBufferSize); // One byte per track as Bool_t. vector<bool> does not store the values as an array.
+  vector<Float_t> trackVertexDistanceZ(trackBufferSize), trackVertexDistanceZError(trackBufferSize);
+  vector<Float_t> trackVertexDistanceXY(trackBufferSize), trackVertexDistanceXYError(trackBufferSize);
+  vector<Float_t> trackNormalizedChi2(trackBufferSize);
+  vector<UChar_t> trackHitsTrackerLayer(trackBufferSize), trackHits(trackBufferSize);
+  vector<Float_t> trackEnergyEcal(trackBufferSize), trackEnergyHcal(trackBufferSize);
+
+  // Generator level particles
+  vector<float> genParticlePt, genParticlePhi, genParticleEta;
+  vector<int> genParticleCharge, genParticleSubevent;
+
+  // Create the output file and the slim forest tree
+  TFile *outputFile = NULL;
+  TTree *slimForest = NULL;
+  MappedForestFile *mappedForest = NULL;
+  MappedForestFile::EventHeader mappedHeader;
+  const void *mappedColumns[MappedForestFile::knColumns];
+
+  if(writeMapped){
+    mappedForest = new MappedForestFile();
+    mappedForest->OpenForWriting(outputFileName);
+  } else {
+    outputFile = new TFile(outputFileName, "RECREATE", "", compression);
+    slimForest = new TTree("slimForest", Form("Slim forest. Data type %d, jet type %d, jet axis %d, trigger %d", dataType, jetType, jetAxis, useTrigger));
+
+    slimForest->Branch("vz", &vz, "vz/F");
+    slimForest->Branch("hiBin", &hiBin, "hiBin/I");
+    slimForest->Branch("ptHat", &ptHat, "ptHat/F");
+    slimForest->Branch("eventWeight", &eventWeight, "eventWeight/F");
+    slimForest->Branch("primaryVertexFilterBit", &primaryVertexFilterBit, "primaryVertexFilterBit/I");
+    slimForest->Branch("beamScrapingFilterBit", &beamScrapingFilterBit, "beamScrapingFilterBit/I");
+    slimForest->Branch("hfCoincidenceFilterBit", &hfCoincidenceFilterBit, "hfCoincidenceFilterBit/I");
+    slimForest->Branch("clusterCompatibilityFilterBit", &clusterCompatibilityFilterBit, "clusterCompatibilityFilterBit/I");
+    if(useTrigger) slimForest->Branch("jetFilterBit", &jetFilterBit, "jetFilterBit/I");
+
+    slimForest->Branch("nJets", &nJets, "nJets/I");
+    slimForest->Branch("jetPt", jetPt.data(), "jetPt[nJets]/F");
+    slimForest->Branch("jetPhi", jetPhi.data(), "jetPhi[nJets]/F");
+    slimForest->Branch("jetEta", jetEta.data(), "jetEta[nJets]/F");
+    slimForest->Branch("jetRawPt", jetRawPt.data(), "jetRawPt[nJets]/F");
+    slimForest->Branch("jetMaxTrackPt", jetMaxTrackPt.data(), "jetMaxTrackPt[nJets]/F");
+
+    slimForest->Branch("nTracks", &nTracks, "nTracks/I");
+    slimForest->Branch("trackPt", trackPt.data(), "trackPt[nTracks]/F");
+    slimForest->Branch("trackPtError", trackPtError.data(), "trackPtError[nTracks]/F");
+    slimForest->Branch("trackPhi", trackPhi.data(), "trackPhi[nTracks]/F");
+    slimForest->Branch("trackEta", trackEta.data(), "trackEta[nTracks]/F");
+    slimForest->Branch("trackHighPurity", trackHighPurity.data(), "trackHighPurity[nTracks]/O");
+    slimForest->Branch("trackVertexDistanceZ", trackVertexDistanceZ.data(), "trackVertexDistanceZ[nTracks]/F");
+    slimForest->Branch("trackVertexDistanceZError", trackVertexDistanceZError.data(), "trackVertexDistanceZError[nTracks]/F");
+    slimForest->Branch("trackVertexDistanceXY", trackVertexDistanceXY.data(), "trackVertexDistanceXY[nTracks]/F");
+    slimForest->Branch("trackVertexDistanceXYError", trackVertexDistanceXYError.data(), "trackVertexDistanceXYError[nTracks]/F");
+    slimForest->Branch("trackNormalizedChi2", trackNormalizedChi2.data(), "trackNormalizedChi2[nTracks]/F");
+    slimForest->Branch("trackHitsTrackerLayer", trackHitsTrackerLayer.data(), "trackHitsTrackerLayer[nTracks]/b");
+    slimForest->Branch("trackHits", trackHits.data(), "trackHits[nTracks]/b");
+    slimForest->Branch("trackEnergyEcal", trackEnergyEcal.data(), "trackEnergyEcal[nTracks]/F");
+    slimForest->Branch("trackEnergyHcal", trackEnergyHcal.data(), "trackEnergyHcal[nTracks]/F");
+
+    if(isMC){
+      slimForest->Branch("nGenJets", &nGenJets, "nGenJets/I");
+      slimForest->Branch("genJetPt", genJetPt.data(), "genJetPt[nGenJets]/F");
+      slimForest->Branch("genJetPhi", genJetPhi.data(), "genJetPhi[nGenJets]/F");
+      slimForest->Branch("genJetEta", genJetEta.data(), "genJetEta[nGenJets]/F");
+      slimForest->Branch("genParticlePt", &genParticlePt);
+      slimForest->Branch("genParticlePhi", &genParticlePhi);
+      slimForest->Branch("genParticleEta", &genParticleEta);
+      slimForest->Branch("genParticleCharge", &genParticleCharge);
+      slimForest->Branch("genParticleSubevent", &genParticleSubevent);
+    }
+  }
+
+  cout << "Converting " << nEvents << " events from " << inputFileName.Data() << " to " << outputFileName.Data() << endl;
+
+  // Copy all the events from the forest to the slim forest
+  for(int iEvent = 0; iEvent < nEvents; iEvent++){
+
+    if(iEvent % 1000 == 0) cout << "Converting event " << iEvent << endl;
+
+    forestReader->GetEvent(iEvent);
+
+    // Grow the buffers if the event does not fit to them, and point the slim forest branches to the new buffers
+    nJets = forestReader->GetNJets();
+    nGenJets = isMC ? forestReader->GetNGeneratorJets() : 0;
+    if(std::max(nJets, nGenJets) > jetBufferSize){
+      jetBufferSize = std::max(nJets, nGenJets);
+      jetPt.resize(jetBufferSize); jetPhi.resize(jetBufferSize); jetEta.resize(jetBufferSize); jetRawPt.resize(jetBufferSize); jetMaxTrackPt.resize(jetBufferSize);
+      genJetPt.resize(jetBufferSize); genJetPhi.resize(jetBufferSize); genJetEta.resize(jetBufferSize);
+      if(!writeMapped){
+        slimForest->SetBranchAddress("jetPt", jetPt.data());
+        slimForest->SetBranchAddress("jetPhi", jetPhi.data());
+        slimForest->SetBranchAddress("jetEta", jetEta.data());
+        slimForest->SetBranchAddress("jetRawPt", jetRawPt.data());
+        slimForest->SetBranchAddress("jetMaxTrackPt", jetMaxTrackPt.data());
+        if(isMC){
+          slimForest->SetBranchAddress("genJetPt", genJetPt.data());
+          slimForest->SetBranchAddress("genJetPhi", genJetPhi.data());
+          slimForest->SetBranchAddress("genJetEta", genJetEta.data());
+        }
+      }
+    }
+
+    nTracks = forestReader->GetNTracks();
+    if(nTracks > trackBufferSize){
+      trackBufferSize = nTracks;
+      trackPt.resize(trackBufferSize); trackPtError.resize(trackBufferSize); trackPhi.resize(trackBufferSize); trackEta.resize(trackBufferSize);
+      trackHighPurity.resize(trackBufferSize);
+      trackVertexDistanceZ.resize(trackBufferSize); trackVertexDistanceZError.resize(trackBufferSize);
+      trackVertexDistanceXY.resize(trackBufferSize); trackVertexDistanceXYError.resize(trackBufferSize);
+      trackNormalizedChi2.resize(trackBufferSize);
+      trackHitsTrackerLayer.resize(trackBufferSize); trackHits.resize(trackBufferSize);
+      trackEnergyEcal.resize(trackBufferSize); trackEnergyHcal.resize(trackBufferSize);
+      if(!writeMapped){
+        slimForest->SetBranchAddress("trackPt", trackPt.data());
+        slimForest->SetBranchAddress("trackPtError", trackPtError.data());
+        slimForest->SetBranchAddress("trackPhi", trackPhi.data());
+        slimForest->SetBranchAddress("trackEta", trackEta.data());
+        slimForest->SetBranchAddress("trackHighPurity", (Bool_t*)trackHighPurity.data()); // The branch type is checked against Bool_t
+        slimForest->SetBranchAddress("trackVertexDistanceZ", trackVertexDistanceZ.data());
+        slimForest->SetBranchAddress("trackVertexDistanceZError", trackVertexDistanceZError.data());
+        slimForest->SetBranchAddress("trackVertexDistanceXY", trackVertexDistanceXY.data());
+        slimForest->SetBranchAddress("trackVertexDistanceXYError", trackVertexDistanceXYError.data());
+        slimForest->SetBranchAddress("trackNormalizedChi2", trackNormalizedChi2.data());
+        slimForest->SetBranchAddress("trackHitsTrackerLayer", trackHitsTrackerLayer.data());
+        slimForest->SetBranchAddress("trackHits", trackHits.data());
+        slimForest->SetBranchAddress("trackEnergyEcal", trackEnergyEcal.data());
+        slimForest->SetBranchAddress("trackEnergyHcal", trackEnergyHcal.data());
+      }
+    }
+
+    // Event level information
+    vz = forestReader->GetVz();
+    hiBin = forestReader->GetHiBin();
+    ptHat = forestReader->GetPtHat();
+    eventWeight = forestReader->GetEventWeight();
+    primaryVertexFilterBit = forestReader->GetPrimaryVertexFilterBit();
+    beamScrapingFilterBit = forestReader->GetBeamScrapingFilterBit();
+    hfCoincidenceFilterBit = forestReader->GetHfCoincidenceFilterBit();
+    clusterCompatibilityFilterBit = forestReader->GetClusterCompatibilityFilterBit();
+    if(useTrigger) jetFilterBit = forestReader->GetJetFilterBit();
+
+    // Jets
+    for(int iJet = 0; iJet < nJets; iJet++){
+      jetPt[iJet] = forestReader->GetJetPt(iJet);
+      jetPhi[iJet] = forestReader->GetJetPhi(iJet);
+      jetEta[iJet] = forestReader->GetJetEta(iJet);
+      jetRawPt[iJet] = forestReader->GetJetRawPt(iJet);
+      jetMaxTrackPt[iJet] = forestReader->GetJetMaxTrackPt(iJet);
+    }
+
+    // Tracks
+    for(int iTrack = 0; iTrack < nTracks; iTrack++){
+      trackPt[iTrack] = forestReader->GetTrackPt(iTrack);
+      trackPtError[iTrack] = forestReader->GetTrackPtError(iTrack);
+      trackPhi[iTrack] = forestReader->GetTrackPhi(iTrack);
+      trackEta[iTrack] = forestReader->GetTrackEta(iTrack);
+      trackHighPurity[iTrack] = forestReader->GetTrackHighPurity(iTrack);
+      trackVertexDistanceZ[iTrack] = forestReader->GetTrackVertexDistanceZ(iTrack);
+      trackVertexDistanceZError[iTrack] = forestReader->GetTrackVertexDistanceZError(iTrack);
+      trackVertexDistanceXY[iTrack] = forestReader->GetTrackVertexDistanceXY(iTrack);
+      trackVertexDistanceXYError[iTrack] = forestReader->GetTrackVertexDistanceXYError(iTrack);
+      trackNormalizedChi2[iTrack] = forestReader->GetTrackNormalizedChi2(iTrack);
+      trackHitsTrackerLayer[iTrack] = forestReader->GetNHitsTrackerLayer(iTrack);
+      trackHits[iTrack] = forestReader->GetNHitsTrack(iTrack);
+      trackEnergyEcal[iTrack] = forestReader->GetTrackEnergyEcal(iTrack);
+      trackEnergyHcal[iTrack] = forestReader->GetTrackEnergyHcal(iTrack);
+    }
+
+    // Generator level jets and particles
+    if(isMC){
+      for(int iJet = 0; iJet < nGenJets; iJet++){
+        genJetPt[iJet] = forestReader->GetGeneratorJetPt(iJet);
+        genJetPhi[iJet] = forestReader->GetGeneratorJetPhi(iJet);
+        genJetEta[iJet] = forestReader->GetGeneratorJetEta(iJet);
+      }
+
+      genParticlePt.clear();
+      genParticlePhi.clear();
+      genParticleEta.clear();
+      genParticleCharge.clear();
+      genParticleSubevent.clear();
+      for(int iParticle = 0; iParticle < forestReader->GetNGenParticles(); iParticle++){
+        genParticlePt.push_back(forestReader->GetGenParticlePt(iParticle));
+        genParticlePhi.push_back(forestReader->GetGenParticlePhi(iParticle));
+        genParticleEta.push_back(forestReader->GetGenParticleEta(iParticle));
+        genParticleCharge.push_back(forestReader->GetGenParticleCharge(iParticle));
+        genParticleSubevent.push_back(forestReader->GetGenParticleSubevent(iParticle));
+      }
+    }
+
+    // Write the event to the mapped file or fill the slim forest tree
+    if(writeMapped){
+      mappedHeader.fVertexZ = vz;
+      mappedHeader.fHiBin = hiBin;
+      mappedHeader.fPtHat = ptHat;
+      mappedHeader.fEventWeight = eventWeight;
+      mappedHeader.fJetFilterBit = useTrigger ? jetFilterBit : 1;
+      mappedHeader.fPrimaryVertexFilterBit = primaryVertexFilterBit;
+      mappedHeader.fBeamScrapingFilterBit = beamScrapingFilterBit;
+      mappedHeader.fHfCoincidenceFilterBit = hfCoincidenceFilterBit;
+      mappedHeader.fClusterCompatibilityFilterBit = clusterCompatibilityFilterBit;
+      mappedHeader.fnObjects[MappedForestFile::kJets] = nJets;
+      mappedHeader.fnObjects[MappedForestFile::kGenJets] = isMC ? nGenJets : 0;
+      mappedHeader.fnObjects[MappedForestFile::kTracks] = nTracks;
+      mappedHeader.fnObjects[MappedForestFile::kGenParticles] = isMC ? genParticlePt.size() : 0;
+      mappedHeader.fPadding[0] = mappedHeader.fPadding[1] = mappedHeader.fPadding[2] = 0;
+
+      mappedColumns[MappedForestFile::kJetPt] = jetPt.data();
+      mappedColumns[MappedForestFile::kJetPhi] = jetPhi.data();
+      mappedColumns[MappedForestFile::kJetEta] = jetEta.data();
+      mappedColumns[MappedForestFile::kJetRawPt] = jetRawPt.data();
+      mappedColumns[MappedForestFile::kJetMaxTrackPt] = jetMaxTrackPt.data();
+      mappedColumns[MappedForestFile::kGenJetPt] = genJetPt.data();
+      mappedColumns[MappedForestFile::kGenJetPhi] = genJetPhi.data();
+      mappedColumns[MappedForestFile::kGenJetEta] = genJetEta.data();
+      mappedColumns[MappedForestFile::kTrackPt] = trackPt.data();
+      mappedColumns[MappedForestFile::kTrackPtError] = trackPtError.data();
+      mappedColumns[MappedForestFile::kTrackPhi] = trackPhi.data();
+      mappedColumns[MappedForestFile::kTrackEta] = trackEta.data();
+      mappedColumns[MappedForestFile::kTrackHighPurity] = trackHighPurity.data();
+      mappedColumns[MappedForestFile::kTrackVertexDistanceZ] = trackVertexDistanceZ.data();
+      mappedColumns[MappedForestFile::kTrackVertexDistanceZError] = trackVertexDistanceZError.data();
+      mappedColumns[MappedForestFile::kTrackVertexDistanceXY] = trackVertexDistanceXY.data();
+      mappedColumns[MappedForestFile::kTrackVertexDistanceXYError] = trackVertexDistanceXYError.data();
+      mappedColumns[MappedForestFile::kTrackNormalizedChi2] = trackNormalizedChi2.data();
+      mappedColumns[MappedForestFile::kTrackHitsTrackerLayer] = trackHitsTrackerLayer.data();
+      mappedColumns[MappedForestFile::kTrackHits] = trackHits.data();
+      mappedColumns[MappedForestFile::kTrackEnergyEcal] = trackEnergyEcal.data();
+      mappedColumns[MappedForestFile::kTrackEnergyHcal] = trackEnergyHcal.data();
+      mappedColumns[MappedForestFile::kGenParticlePt] = genParticlePt.data();
+      mappedColumns[MappedForestFile::kGenParticlePhi] = genParticlePhi.data();
+      mappedColumns[MappedForestFile::kGenParticleEta] = genParticleEta.data();
+      mappedColumns[MappedForestFile::kGenParticleCharge] = genParticleCharge.data();
+      mappedColumns[MappedForestFile::kGenParticleSubevent] = genParticleSubevent.data();
+
+      mappedForest->WriteEvent(mappedHeader, mappedColumns);
+    } else {
+      slimForest->Fill();
+    }
+
+  } // Event loop
+
+  // Write the slim forest to the output file
+  if(writeMapped){
+    mappedForest->CloseForWriting();
+    delete mappedForest;
+  } else {
+    outputFile->cd();
+    slimForest->Write();
+    outputFile->Close();
+  }
+  forestReader->DisconnectForest();
+  inputFile->Close();
+
+  // After writing to the file, delete all created objects
+  delete forestReader;
+
+}
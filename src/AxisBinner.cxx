@@ -0,0 +1,139 @@
+// Implementation of the bin search for one histogram axis
+
+// Own includes
+#include "AxisBinner.h"
+
+/*
+ * Default constructor
+ */
+AxisBinner::AxisBinner() :
+  fBinningType(kUniform),
+  fnBins(1),
+  fMinimum(0),
+  fMaximum(1),
+  fBinEdges(),
+  fLogShift(0),
+  fLogOffset(0),
+  fInverseLogBinWidth(0)
+{
+  // Default constructor
+}
+
+/*
+ * Copy constructor
+ */
+AxisBinner::AxisBinner(const AxisBinner& in) :
+  fBinningType(in.fBinningType),
+  fnBins(in.fnBins),
+  fMinimum(in.fMinimum),
+  fMaximum(in.fMaximum),
+  fBinEdges(in.fBinEdges),
+  fLogShift(in.fLogShift),
+  fLogOffset(in.fLogOffset),
+  fInverseLogBinWidth(in.fInverseLogBinWidth)
+{
+  // Copy constructor
+}
+
+/*
+ * Destructor
+ */
+AxisBinner::~AxisBinner(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+AxisBinner& AxisBinner::operator=(const AxisBinner& in){
+  if(&in == this) return *this;
+
+  fBinningType = in.fBinningType;
+  fnBins = in.fnBins;
+  fMinimum = in.fMinimum;
+  fMaximum = in.fMaximum;
+  fBinEdges = in.fBinEdges;
+  fLogShift = in.fLogShift;
+  fLogOffset = in.fLogOffset;
+  fInverseLogBinWidth = in.fInverseLogBinWidth;
+
+  return *this;
+}
+
+/*
+ * Setter for bins of equal width
+ *
+ *  Arguments:
+ *   const Int_t nBins = Number of bins
+ *   const Double_t minimum = Low edge of the first bin
+ *   const Double_t maximum = High edge of the last bin
+ */
+void AxisBinner::SetUniformBins(const Int_t nBins, const Double_t minimum, const Double_t maximum){
+  fBinningType = kUniform;
+  fnBins = nBins;
+  fMinimum = minimum;
+  fMaximum = maximum;
+  fBinEdges.clear();
+}
+
+/*
+ * Setter for bins with given edges
+ *
+ *  Arguments:
+ *   const Int_t nBins = Number of bins
+ *   const Double_t *binEdges = Array of nBins+1 bin edges in increasing order
+ */
+void AxisBinner::SetVariableBins(const Int_t nBins, const Double_t *binEdges){
+  fBinningType = kVariable;
+  fnBins = nBins;
+  fBinEdges.assign(binEdges, binEdges+nBins+1);
+  fMinimum = fBinEdges[0];
+  fMaximum = fBinEdges[nBins];
+}
+
+/*
+ * Setter for logarithmic bins with shifted edges. The edges must be (minimum+shift)*exp(i*width)-shift for
+ * some width, such that the logarithms of the shifted edges are evenly spaced.
+ *
+ *  Arguments:
+ *   const Int_t nBins = Number of bins
+ *   const Double_t *binEdges = Array of nBins+1 bin edges in increasing order
+ *   const Double_t shift = Shift added to the edges before taking the logarithm
+ */
+void AxisBinner::SetLogarithmicBins(const Int_t nBins, const Double_t *binEdges, const Double_t shift){
+  SetVariableBins(nBins, binEdges);
+  if(fMinimum+shift <= 0){
+    cout << "Error! The shifted low edge " << fMinimum+shift << " of a logarithmic axis must be positive" << endl;
+    assert(0);
+  }
+
+  fBinningType = kLogarithmic;
+  fLogShift = shift;
+  fLogOffset = TMath::Log(fMinimum+shift);
+  fInverseLogBinWidth = nBins / (TMath::Log(fMaximum+shift) - fLogOffset);
+}
+
+/*
+ * Setter for the same bins as in a ROOT axis. Axes with variable bins use the edges of the axis, such that the
+ * bins found are the same as from TAxis::FindBin.
+ *
+ *  Arguments:
+ *   const TAxis *axis = Axis from which the binning is taken
+ */
+void AxisBinner::SetBins(const TAxis *axis){
+  if(axis->GetXbins()->GetSize() > 0){
+    SetVariableBins(axis->GetNbins(), axis->GetXbins()->GetArray());
+  } else {
+    SetUniformBins(axis->GetNbins(), axis->GetXmin(), axis->GetXmax());
+  }
+}
+
+// Getter for the type of the binning
+Int_t AxisBinner::GetBinningType() const{
+  return fBinningType;
+}
+
+// Getter for the number of regular bins
+Int_t AxisBinner::GetNbins() const{
+  return fnBins;
+}
@@ -0,0 +1,96 @@
+// Class for finding the bin of a value on one histogram axis
+//
+//===========================================================
+// AxisBinner.h
+//
+// The bin search is prepared once when the histogram is created, using the kind of binning the axis has:
+//  - Uniform axes use the closed-form bin index, as ROOT does
+//  - Logarithmic axes with edges (minimum+shift)*exp(i*width)-shift, like DeltaR, use the closed-form index
+//    from the logarithm. The index is then corrected by comparing to the neighbouring stored edges, such that
+//    rounding can not move a value to a different bin than the edge search would.
+//  - Short variable axes, like the pT and centrality axes from the card, count the edges below the value
+//    without branches. Longer variable axes use a binary search.
+// The bin numbering follows ROOT: 0 is underflow, 1 to nBins are the regular bins and nBins+1 is overflow.
+// Values that are not a number go to the overflow bin, as in TAxis.
+//===========================================================
+
+#ifndef AXISBINNER_H
+#define AXISBINNER_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+// Root includes
+#include <TMath.h>
+#include <TAxis.h>
+
+using namespace std;
+
+class AxisBinner{
+
+private:
+  static const Int_t fMaxLinearSearchBins = 32; // Variable axes with more bins than this use a binary search
+
+public:
+
+  enum enumBinningType{kUniform, kLogarithmic, kVariable, knBinningTypes};
+
+  // Constructors and destructor
+  AxisBinner();                                 // Default constructor
+  AxisBinner(const AxisBinner& in);             // Copy constructor
+  ~AxisBinner();                                // Destructor
+  AxisBinner& operator=(const AxisBinner& obj); // Equal sign operator
+
+  // Setters for the binning
+  void SetUniformBins(const Int_t nBins, const Double_t minimum, const Double_t maximum); // Setter for bins of equal width
+  void SetVariableBins(const Int_t nBins, const Double_t *binEdges);                       // Setter for bins with given edges
+  void SetLogarithmicBins(const Int_t nBins, const Double_t *binEdges, const Double_t shift); // Setter for logarithmic bins with shifted edges
+  void SetBins(const TAxis *axis);                                                         // Setter for the same bins as in a ROOT axis
+
+  // Getters
+  Int_t GetBinningType() const; // Getter for the type of the binning
+  Int_t GetNbins() const;       // Getter for the number of regular bins
+
+  // Find the bin for a value. Defined here, since this is called for every filled pair.
+  Int_t FindBin(const Double_t x) const{
+    if(x < fMinimum) return 0;
+    if(!(x < fMaximum)) return fnBins+1;
+    if(fBinningType == kUniform) return 1 + Int_t(fnBins*(x-fMinimum)/(fMaximum-fMinimum));
+    if(fBinningType == kLogarithmic) return FindLogarithmicBin(x);
+    return FindVariableBin(x);
+  }
+
+private:
+
+  // Bin search for logarithmic and variable axes. Values must be inside the axis range.
+  Int_t FindLogarithmicBin(const Double_t x) const{
+    Int_t bin = 1 + Int_t((TMath::Log(x+fLogShift) - fLogOffset) * fInverseLogBinWidth);
+    bin = TMath::Min(TMath::Max(bin, 1), fnBins);
+    bin -= (x < fBinEdges[bin-1]);
+    bin += (x >= fBinEdges[bin]);
+    return bin;
+  }
+  Int_t FindVariableBin(const Double_t x) const{
+    if(fnBins > fMaxLinearSearchBins) return std::upper_bound(fBinEdges.begin(), fBinEdges.end(), x) - fBinEdges.begin();
+    Int_t bin = 1;
+    for(Int_t iEdge = 1; iEdge < fnBins; iEdge++){
+      bin += (x >= fBinEdges[iEdge]);
+    }
+    return bin;
+  }
+
+  Int_t fBinningType;                // Type of the binning, see enumBinningType
+  Int_t fnBins;                      // Number of regular bins
+  Double_t fMinimum;                 // Low edge of the first bin
+  Double_t fMaximum;                 // High edge of the last bin
+  std::vector<Double_t> fBinEdges;   // Bin edges for logarithmic and variable axes
+  Double_t fLogShift;                // Shift added to the values before taking the logarithm
+  Double_t fLogOffset;               // Logarithm of the shifted low edge of the first bin
+  Double_t fInverseLogBinWidth;      // One over the bin width in the logarithm of the shifted values
+
+};
+
+#endif
@@ -0,0 +1,356 @@
+// Implementation of the dense multidimensional histogram
+
+// Own includes
+#include "DenseHistogram.h"
+
+/*
+ * Default constructor
+ */
+DenseHistogram::DenseHistogram() :
+  fName(""),
+  fTitle(""),
+  fnDimensions(0),
+  fAxes(0),
+  fAxisBinners(0),
+  fBinStride(0),
+  fnBins(0),
+  fContents(0),
+  fSumw2(0),
+  fEntries(0)
+{
+  // Default constructor
+}
+
+/*
+ * Custom constructor. The arguments are the same as for THnSparseF.
+ *
+ *  Arguments:
+ *   const char *name = Name of the histogram
+ *   const char *title = Title of the histogram
+ *   const Int_t nDimensions = Number of axes
+ *   const Int_t *nBins = Number of bins for each axis
+ *   const Double_t *lowBinBorder = Low border for each axis
+ *   const Double_t *highBinBorder = High border for each axis
+ */
+DenseHistogram::DenseHistogram(const char *name, const char *title, const Int_t nDimensions, const Int_t *nBins, const Double_t *lowBinBorder, const Double_t *highBinBorder) :
+  fName(name),
+  fTitle(title),
+  fnDimensions(nDimensions),
+  fAxes(0),
+  fAxisBinners(0),
+  fBinStride(0),
+  fnBins(0),
+  fContents(0),
+  fSumw2(0),
+  fEntries(0)
+{
+  // Custom constructor
+  fAxes = new TAxis*[fnDimensions];
+  fAxisBinners = new AxisBinner[fnDimensions];
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    fAxes[iAxis] = new TAxis(nBins[iAxis], lowBinBorder[iAxis], highBinBorder[iAxis]);
+    fAxisBinners[iAxis].SetUniformBins(nBins[iAxis], lowBinBorder[iAxis], highBinBorder[iAxis]);
+  }
+  AllocateBins();
+}
+
+/*
+ * Copy constructor
+ */
+DenseHistogram::DenseHistogram(const DenseHistogram& in) :
+  fName(in.fName),
+  fTitle(in.fTitle),
+  fnDimensions(in.fnDimensions),
+  fAxes(0),
+  fAxisBinners(0),
+  fBinStride(0),
+  fnBins(0),
+  fContents(0),
+  fSumw2(0),
+  fEntries(in.fEntries)
+{
+  // Copy constructor
+  fAxes = new TAxis*[fnDimensions];
+  fAxisBinners = new AxisBinner[fnDimensions];
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    fAxes[iAxis] = new TAxis(*in.fAxes[iAxis]);
+    fAxisBinners[iAxis] = in.fAxisBinners[iAxis];
+  }
+  AllocateBins();
+  memcpy(fContents, in.fContents, fnBins*sizeof(Float_t));
+  if(in.fSumw2){
+    Sumw2();
+    memcpy(fSumw2, in.fSumw2, fnBins*sizeof(Double_t));
+  }
+}
+
+/*
+ * Destructor
+ */
+DenseHistogram::~DenseHistogram(){
+  // Destructor
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    delete fAxes[iAxis];
+  }
+  delete [] fAxes;
+  delete [] fAxisBinners;
+  delete [] fBinStride;
+  free(fContents);
+  free(fSumw2);
+}
+
+/*
+ * Equal sign operator
+ */
+DenseHistogram& DenseHistogram::operator=(const DenseHistogram& in){
+  if(&in == this) return *this;
+
+  // Release the old binning before copying the new one
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    delete fAxes[iAxis];
+  }
+  delete [] fAxes;
+  delete [] fAxisBinners;
+  delete [] fBinStride;
+  free(fContents);
+  free(fSumw2);
+  fSumw2 = 0;
+
+  fName = in.fName;
+  fTitle = in.fTitle;
+  fnDimensions = in.fnDimensions;
+  fAxes = new TAxis*[fnDimensions];
+  fAxisBinners = new AxisBinner[fnDimensions];
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    fAxes[iAxis] = new TAxis(*in.fAxes[iAxis]);
+    fAxisBinners[iAxis] = in.fAxisBinners[iAxis];
+  }
+  AllocateBins();
+  memcpy(fContents, in.fContents, fnBins*sizeof(Float_t));
+  if(in.fSumw2){
+    Sumw2();
+    memcpy(fSumw2, in.fSumw2, fnBins*sizeof(Double_t));
+  }
+  fEntries = in.fEntries;
+
+  return *this;
+}
+
+/*
+ * Find the bin strides and allocate the bin arrays. The first axis changes fastest in the linear index,
+ * as in the THn classes. Each axis has underflow and overflow bins in addition to the regular bins.
+ */
+void DenseHistogram::AllocateBins(){
+  fBinStride = new Long64_t[fnDimensions];
+  fnBins = 1;
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    fBinStride[iAxis] = fnBins;
+    fnBins *= fAxes[iAxis]->GetNbins() + 2;
+  }
+
+  fContents = (Float_t*) calloc(fnBins, sizeof(Float_t));
+  if(fContents == 0){
+    cout << "Error! Could not allocate " << fnBins << " bins for histogram " << fName.Data() << endl;
+    assert(0);
+  }
+}
+
+/*
+ * Store also the sum of squared weights for each bin
+ */
+void DenseHistogram::Sumw2(){
+  if(fSumw2) return;
+  fSumw2 = (Double_t*) calloc(fnBins, sizeof(Double_t));
+  if(fSumw2 == 0){
+    cout << "Error! Could not allocate the squared weights for histogram " << fName.Data() << endl;
+    assert(0);
+  }
+}
+
+/*
+ * Setter for variable bin edges of one axis. The number of bins in the axis does not change.
+ *
+ *  Arguments:
+ *   const Int_t iAxis = Index of the axis
+ *   const Double_t *binEdges = Array of GetNbins()+1 bin edges
+ */
+void DenseHistogram::SetBinEdges(const Int_t iAxis, const Double_t *binEdges){
+  fAxes[iAxis]->Set(fAxes[iAxis]->GetNbins(), binEdges);
+  fAxisBinners[iAxis].SetVariableBins(fAxes[iAxis]->GetNbins(), binEdges);
+}
+
+/*
+ * Setter for logarithmic bin edges of one axis. The bins are found from the logarithm of the shifted value.
+ *
+ *  Arguments:
+ *   const Int_t iAxis = Index of the axis
+ *   const Double_t *binEdges = Array of GetNbins()+1 bin edges of the form (minimum+shift)*exp(i*width)-shift
+ *   const Double_t shift = Shift used to calculate the bin edges
+ */
+void DenseHistogram::SetLogarithmicBinEdges(const Int_t iAxis, const Double_t *binEdges, const Double_t shift){
+  fAxes[iAxis]->Set(fAxes[iAxis]->GetNbins(), binEdges);
+  fAxisBinners[iAxis].SetLogarithmicBins(fAxes[iAxis]->GetNbins(), binEdges, shift);
+}
+
+// Getter for the histogram name
+const char* DenseHistogram::GetName() const{
+  return fName.Data();
+}
+
+// Getter for the number of axes
+Int_t DenseHistogram::GetNdimensions() const{
+  return fnDimensions;
+}
+
+// Getter for an axis
+TAxis* DenseHistogram::GetAxis(const Int_t iAxis) const{
+  return fAxes[iAxis];
+}
+
+// Getter for the bin search of an axis
+const AxisBinner* DenseHistogram::GetAxisBinner(const Int_t iAxis) const{
+  return &fAxisBinners[iAxis];
+}
+
+// Getter for the total number of bins, including underflow and overflow
+Long64_t DenseHistogram::GetNbins() const{
+  return fnBins;
+}
+
+// Getter for the change in the linear bin index for one bin step in an axis
+Long64_t DenseHistogram::GetBinStride(const Int_t iAxis) const{
+  return fBinStride[iAxis];
+}
+
+// Getter for the number of fills
+Double_t DenseHistogram::GetEntries() const{
+  return fEntries;
+}
+
+// Getter for the size of the bin arrays in bytes. Only the filled memory pages are resident.
+Long64_t DenseHistogram::GetMemorySize() const{
+  Long64_t binSize = sizeof(Float_t);
+  if(fSumw2) binSize += sizeof(Double_t);
+  return fnBins * binSize;
+}
+
+// Getter for the size of the memory pages of the bin arrays that have filled bins. This is the resident memory of the histogram.
+Long64_t DenseHistogram::GetFilledMemorySize() const{
+  Long64_t memorySize = GetFilledPageSize((const char*)fContents, fnBins*sizeof(Float_t));
+  if(fSumw2) memorySize += GetFilledPageSize((const char*)fSumw2, fnBins*sizeof(Double_t));
+  return memorySize;
+}
+
+/*
+ * Size of the memory pages of an array that have at least one byte that is not zero. The pages of the
+ * calloc'd arrays are mapped when they are first written, so this counts the pages holding filled bins.
+ * Pages where the filled weights sum up to zero are not counted.
+ *
+ *  Arguments:
+ *   const char *array = Array for which the filled pages are counted
+ *   const Long64_t arraySize = Size of the array in bytes
+ *
+ *   return: Size of the filled pages in bytes
+ */
+Long64_t DenseHistogram::GetFilledPageSize(const char *array, const Long64_t arraySize) const{
+  Long64_t filledSize = 0;
+  for(Long64_t pageStart = 0; pageStart < arraySize; pageStart += fPageSize){
+    const Long64_t pageEnd = TMath::Min(pageStart + fPageSize, arraySize);
+    for(Long64_t iByte = pageStart; iByte < pageEnd; iByte++){
+      if(array[iByte] != 0){
+        filledSize += pageEnd - pageStart;
+        break;
+      }
+    }
+  }
+  return filledSize;
+}
+
+/*
+ * Fill the histogram at the given coordinates
+ *
+ *  Arguments:
+ *   const Double_t *coordinates = Value for each axis
+ *   const Double_t weight = Weight for the fill
+ *
+ *   return: Linear index of the filled bin
+ */
+Long64_t DenseHistogram::Fill(const Double_t *coordinates, const Double_t weight){
+  Long64_t bin = 0;
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    bin += fAxisBinners[iAxis].FindBin(coordinates[iAxis]) * fBinStride[iAxis];
+  }
+  FillBin(bin, weight);
+  return bin;
+}
+
+/*
+ * Create an empty THnSparseF with the same name and binning as this histogram
+ *
+ *   return: New THnSparseF owned by the caller
+ */
+THnSparseF* DenseHistogram::CreateEmptySparse() const{
+
+  Int_t nBins[fnDimensions];
+  Double_t lowBinBorder[fnDimensions];
+  Double_t highBinBorder[fnDimensions];
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    nBins[iAxis] = fAxes[iAxis]->GetNbins();
+    lowBinBorder[iAxis] = fAxes[iAxis]->GetXmin();
+    highBinBorder[iAxis] = fAxes[iAxis]->GetXmax();
+  }
+
+  THnSparseF *sparseHistogram = new THnSparseF(fName.Data(), fTitle.Data(), fnDimensions, nBins, lowBinBorder, highBinBorder);
+  if(fSumw2) sparseHistogram->Sumw2();
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    if(fAxes[iAxis]->GetXbins()->GetSize() > 0) sparseHistogram->SetBinEdges(iAxis, fAxes[iAxis]->GetXbins()->GetArray());
+  }
+
+  return sparseHistogram;
+}
+
+/*
+ * Convert the histogram to a THnSparseF with the same name and binning. Only the bins with
+ * content are created in the sparse histogram.
+ *
+ *   return: New THnSparseF owned by the caller
+ */
+THnSparseF* DenseHistogram::CreateSparse() const{
+
+  THnSparseF *sparseHistogram = CreateEmptySparse();
+
+  // Go through the linear bins and keep track of the bin index of each axis like an odometer
+  Int_t binIndex[fnDimensions];
+  for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+    binIndex[iAxis] = 0;
+  }
+
+  Long64_t sparseBin;
+  for(Long64_t iBin = 0; iBin < fnBins; iBin++){
+
+    if(fContents[iBin] != 0 || (fSumw2 && fSumw2[iBin] != 0)){
+      sparseBin = sparseHistogram->GetBin(binIndex);
+      sparseHistogram->SetBinContent(sparseBin, fContents[iBin]);
+      if(fSumw2) sparseHistogram->SetBinError2(sparseBin, fSumw2[iBin]);
+    }
+
+    for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+      if(++binIndex[iAxis] < fAxes[iAxis]->GetNbins() + 2) break;
+      binIndex[iAxis] = 0;
+    }
+  }
+
+  // Setting the bin contents counts entries in the sparse histogram, so the number of fills is set afterwards
+  sparseHistogram->SetEntries(fEntries);
+
+  return sparseHistogram;
+}
+
+/*
+ * Write the histogram as THnSparseF to the current directory
+ */
+void DenseHistogram::Write() const{
+  THnSparseF *sparseHistogram = CreateSparse();
+  sparseHistogram->Write();
+  delete sparseHistogram;
+}
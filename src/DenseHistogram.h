@@ -0,0 +1,108 @@
+// Multidimensional histogram with all the bins stored in one flat array
+//
+//===========================================================
+// DenseHistogram.h
+//
+// Replacement for THnSparseF for histograms where all the axes have a small, fixed number of bins. The bin
+// contents and the squared weights are kept in flat arrays, including the underflow and overflow bins of
+// every axis, and the linear bin index is found with one multiply-add per axis. There is no hashing and no
+// coordinates are stored with the bins. The bins of the values are found with an AxisBinner prepared for the
+// binning of each axis, instead of the general search in TAxis. The arrays are allocated with calloc, such
+// that the operating system only maps the memory pages that are actually filled. Only those pages take
+// memory, and GetFilledMemorySize gives their size. Pairs spread over the whole binning fill most of the
+// pages, so large binnings should still stay in THnSparseF.
+//
+// ROOT can not read this class from a file. When the histogram is written, it is converted to a THnSparseF
+// with the same name and binning, such that the output file looks the same as before.
+//===========================================================
+
+#ifndef DENSEHISTOGRAM_H
+#define DENSEHISTOGRAM_H
+
+// C++ includes
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <assert.h>
+
+// Root includes
+#include <TString.h>
+#include <TAxis.h>
+#include <TMath.h>
+#include <THnSparse.h>
+
+// Own includes
+#include "AxisBinner.h"
+
+using namespace std;
+
+class DenseHistogram{
+
+public:
+
+  // Constructors and destructor
+  DenseHistogram();                                     // Default constructor
+  DenseHistogram(const char *name, const char *title, const Int_t nDimensions, const Int_t *nBins, const Double_t *lowBinBorder, const Double_t *highBinBorder); // Custom constructor
+  DenseHistogram(const DenseHistogram& in);             // Copy constructor
+  ~DenseHistogram();                                    // Destructor
+  DenseHistogram& operator=(const DenseHistogram& obj); // Equal sign operator
+
+  // Setters
+  void Sumw2();                                                 // Store also the sum of squared weights for each bin
+  void SetBinEdges(const Int_t iAxis, const Double_t *binEdges); // Setter for variable bin edges of one axis
+  void SetLogarithmicBinEdges(const Int_t iAxis, const Double_t *binEdges, const Double_t shift); // Setter for logarithmic bin edges of one axis
+
+  // Getters
+  const char* GetName() const;            // Getter for the histogram name
+  Int_t GetNdimensions() const;           // Getter for the number of axes
+  TAxis* GetAxis(const Int_t iAxis) const; // Getter for an axis
+  const AxisBinner* GetAxisBinner(const Int_t iAxis) const; // Getter for the bin search of an axis
+  Long64_t GetNbins() const;              // Getter for the total number of bins, including underflow and overflow
+  Long64_t GetBinStride(const Int_t iAxis) const; // Getter for the change in the linear bin index for one bin step in an axis
+  Double_t GetEntries() const;            // Getter for the number of fills
+  Long64_t GetMemorySize() const;         // Getter for the size of the bin arrays in bytes
+  Long64_t GetFilledMemorySize() const;   // Getter for the size of the memory pages of the bin arrays that have filled bins
+
+  // Methods
+  Long64_t Fill(const Double_t *coordinates, const Double_t weight = 1); // Fill the histogram at the given coordinates
+  Double_t GetBinContent(const Long64_t bin) const;  // Getter for the content of a bin
+  Double_t GetBinError2(const Long64_t bin) const;   // Getter for the sum of squared weights in a bin
+  THnSparseF* CreateEmptySparse() const;             // Create an empty THnSparseF with the same binning
+  THnSparseF* CreateSparse() const;                  // Convert the histogram to a THnSparseF
+  void Write() const;                                // Write the histogram as THnSparseF to the current directory
+
+  // Filling by bin indices. Defined here, since these are called in the pair loops.
+  Long64_t GetBin(const Int_t *binIndex) const{     // Linear bin index from the bin indices of all the axes
+    Long64_t bin = 0;
+    for(Int_t iAxis = 0; iAxis < fnDimensions; iAxis++){
+      bin += binIndex[iAxis] * fBinStride[iAxis];
+    }
+    return bin;
+  }
+  void FillBin(const Long64_t bin, const Double_t weight){ // Add a weight to a bin given by the linear index
+    fContents[bin] += weight;
+    if(fSumw2) fSumw2[bin] += weight*weight;
+    fEntries++;
+  }
+
+private:
+
+  void AllocateBins(); // Find the bin strides and allocate the bin arrays
+  Long64_t GetFilledPageSize(const char *array, const Long64_t arraySize) const; // Size of the pages of an array that are not all zero
+
+  static const Long64_t fPageSize = 4096; // Size of a memory page mapped by the operating system
+
+  TString fName;            // Name of the histogram
+  TString fTitle;           // Title of the histogram
+  Int_t fnDimensions;       // Number of axes
+  TAxis **fAxes;            // Axes of the histogram
+  AxisBinner *fAxisBinners; // Bin search for each axis
+  Long64_t *fBinStride;     // Change in the linear bin index when the bin index of an axis grows by one
+  Long64_t fnBins;          // Total number of bins, including underflow and overflow
+  Float_t *fContents;       // Bin contents. Float precision as in THnSparseF.
+  Double_t *fSumw2;         // Sums of squared weights for the bins. Null if not calculated.
+  Double_t fEntries;        // Number of fills
+
+};
+
+#endif
@@ -0,0 +1,232 @@
+// Implementation of the event selection index
+
+// Root includes
+#include <TSystem.h>
+
+// Own includes
+#include "EventSelectionIndex.h"
+
+/*
+ * Default constructor
+ */
+EventSelectionIndex::EventSelectionIndex() :
+  fEvents()
+{
+  // Default constructor
+}
+
+/*
+ * Copy constructor
+ */
+EventSelectionIndex::EventSelectionIndex(const EventSelectionIndex& in) :
+  fEvents(in.fEvents)
+{
+  // Copy constructor
+}
+
+/*
+ * Destructor
+ */
+EventSelectionIndex::~EventSelectionIndex(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+EventSelectionIndex& EventSelectionIndex::operator=(const EventSelectionIndex& in){
+  if(&in == this) return *this;
+
+  fEvents = in.fEvents;
+
+  return *this;
+}
+
+/*
+ * Read the index from a sidecar file
+ *
+ *  Arguments:
+ *   const char *indexFileName = Name of the sidecar file
+ *   const Long64_t nEvents = Number of events in the forest. The index is only used if it has the same number of events.
+ *   const TString description = Description of the settings affecting the index content. Must match the one used for writing.
+ *   const TString forestIdentity = Identity of the forest file from GetForestIdentity. Must match the one used for writing.
+ *
+ *   return: True if a matching index was read, false otherwise
+ */
+Bool_t EventSelectionIndex::ReadIndex(const char *indexFileName, const Long64_t nEvents, const TString description, const TString forestIdentity){
+
+  fEvents.clear();
+
+  // Do not try to open files that do not exist
+  if(gSystem->AccessPathName(indexFileName)) return false;
+
+  TDirectory *savedDirectory = gDirectory;
+  TFile *indexFile = TFile::Open(indexFileName);
+  savedDirectory->cd();
+  if(!indexFile || indexFile->IsZombie()) return false;
+
+  // The index must be made for the same forest with the same settings
+  TTree *indexTree = (TTree*)indexFile->Get("eventIndex");
+  TNamed *indexIdentity = (TNamed*)indexFile->Get("forestIdentity");
+  if(indexTree == NULL || indexTree->GetEntries() != nEvents || description != indexTree->GetTitle() || indexIdentity == NULL || forestIdentity != indexIdentity->GetTitle()){
+    indexFile->Close();
+    delete indexFile;
+    return false;
+  }
+
+  EventInformation eventInformation;
+  indexTree->SetBranchAddress("vz",&eventInformation.fVertexZ);
+  indexTree->SetBranchAddress("hiBin",&eventInformation.fHiBin);
+  indexTree->SetBranchAddress("ptHat",&eventInformation.fPtHat);
+  indexTree->SetBranchAddress("eventWeight",&eventInformation.fEventWeight);
+  indexTree->SetBranchAddress("jetFilterBit",&eventInformation.fJetFilterBit);
+  indexTree->SetBranchAddress("primaryVertexFilterBit",&eventInformation.fPrimaryVertexFilterBit);
+  indexTree->SetBranchAddress("beamScrapingFilterBit",&eventInformation.fBeamScrapingFilterBit);
+  indexTree->SetBranchAddress("hfCoincidenceFilterBit",&eventInformation.fHfCoincidenceFilterBit);
+  indexTree->SetBranchAddress("clusterCompatibilityFilterBit",&eventInformation.fClusterCompatibilityFilterBit);
+
+  fEvents.reserve(nEvents);
+  for(Long64_t iEvent = 0; iEvent < nEvents; iEvent++){
+    indexTree->GetEntry(iEvent);
+    fEvents.push_back(eventInformation);
+  }
+
+  indexFile->Close();
+  delete indexFile;
+  return true;
+}
+
+/*
+ * Read the event level information of all the events from the forest. Only the small event level trees are read.
+ *
+ *  Arguments:
+ *   ForestReader *eventReader = Reader connected to the forest
+ */
+void EventSelectionIndex::BuildIndex(ForestReader *eventReader){
+
+  const Int_t nEvents = eventReader->GetNEvents();
+  fEvents.clear();
+  fEvents.reserve(nEvents);
+
+  for(Int_t iEvent = 0; iEvent < nEvents; iEvent++){
+    eventReader->GetEventInformation(iEvent);
+    fEvents.push_back(ReadEventInformation(eventReader));
+  }
+}
+
+/*
+ * Write the index to a sidecar file. If the file cannot be written, the index is only used for the current run.
+ *
+ *  Arguments:
+ *   const char *indexFileName = Name of the sidecar file
+ *   const TString description = Description of the settings affecting the index content
+ *   const TString forestIdentity = Identity of the forest file from GetForestIdentity
+ */
+void EventSelectionIndex::WriteIndex(const char *indexFileName, const TString description, const TString forestIdentity) const{
+
+  TDirectory *savedDirectory = gDirectory;
+  TFile *indexFile = TFile::Open(indexFileName, "RECREATE");
+  if(!indexFile || indexFile->IsZombie()){
+    cout << "EventSelectionIndex: Could not write the index file " << indexFileName << endl;
+    savedDirectory->cd();
+    return;
+  }
+
+  EventInformation eventInformation;
+  TTree *indexTree = new TTree("eventIndex", description.Data());
+  indexTree->Branch("vz", &eventInformation.fVertexZ, "vz/F");
+  indexTree->Branch("hiBin", &eventInformation.fHiBin, "hiBin/I");
+  indexTree->Branch("ptHat", &eventInformation.fPtHat, "ptHat/F");
+  indexTree->Branch("eventWeight", &eventInformation.fEventWeight, "eventWeight/F");
+  indexTree->Branch("jetFilterBit", &eventInformation.fJetFilterBit, "jetFilterBit/I");
+  indexTree->Branch("primaryVertexFilterBit", &eventInformation.fPrimaryVertexFilterBit, "primaryVertexFilterBit/I");
+  indexTree->Branch("beamScrapingFilterBit", &eventInformation.fBeamScrapingFilterBit, "beamScrapingFilterBit/I");
+  indexTree->Branch("hfCoincidenceFilterBit", &eventInformation.fHfCoincidenceFilterBit, "hfCoincidenceFilterBit/I");
+  indexTree->Branch("clusterCompatibilityFilterBit", &eventInformation.fClusterCompatibilityFilterBit, "clusterCompatibilityFilterBit/I");
+
+  for(const EventInformation &event : fEvents){
+    eventInformation = event;
+    indexTree->Fill();
+  }
+
+  TNamed *indexIdentity = new TNamed("forestIdentity", forestIdentity.Data());
+  indexIdentity->Write();
+
+  indexFile->Write();
+  indexFile->Close();
+  delete indexFile;
+  savedDirectory->cd();
+}
+
+// Getter for the number of events in the index
+Long64_t EventSelectionIndex::GetNEvents() const{
+  return fEvents.size();
+}
+
+// Getter for the event level information of one event
+const EventSelectionIndex::EventInformation& EventSelectionIndex::GetEventInformation(const Long64_t iEvent) const{
+  return fEvents[iEvent];
+}
+
+/*
+ * Collect the event level information of the current event from a reader
+ *
+ *  Arguments:
+ *   const ForestReader *eventReader = Reader from which the event level information is taken
+ *
+ *   return: Event level information of the current event in the reader
+ */
+EventSelectionIndex::EventInformation EventSelectionIndex::ReadEventInformation(const ForestReader *eventReader){
+  EventInformation eventInformation;
+  eventInformation.fVertexZ = eventReader->GetVz();
+  eventInformation.fHiBin = eventReader->GetHiBin();
+  eventInformation.fPtHat = eventReader->GetPtHat();
+  eventInformation.fEventWeight = eventReader->GetEventWeight();
+  eventInformation.fJetFilterBit = eventReader->GetJetFilterBit();
+  eventInformation.fPrimaryVertexFilterBit = eventReader->GetPrimaryVertexFilterBit();
+  eventInformation.fBeamScrapingFilterBit = eventReader->GetBeamScrapingFilterBit();
+  eventInformation.fHfCoincidenceFilterBit = eventReader->GetHfCoincidenceFilterBit();
+  eventInformation.fClusterCompatibilityFilterBit = eventReader->GetClusterCompatibilityFilterBit();
+  return eventInformation;
+}
+
+/*
+ * Name of the sidecar file for a forest file. For local files the index is written next to the forest.
+ * Remote files cannot be written to, so the index for them is written to the working directory. Remote
+ * files with the same name in different locations get different index files from a hash of the full URL.
+ *
+ *  Arguments:
+ *   const TString forestFileName = Name of the forest file
+ *
+ *   return: Name of the index file
+ */
+TString EventSelectionIndex::GetIndexFileName(const TString forestFileName){
+  TString indexFileName = forestFileName;
+  const Bool_t isRemoteFile = forestFileName.Contains("://");
+  if(isRemoteFile) indexFileName = gSystem->BaseName(forestFileName.Data());
+  if(indexFileName.EndsWith(".root")) indexFileName.Remove(indexFileName.Length()-5);
+  if(isRemoteFile) indexFileName.Append(Form("_%08x", forestFileName.Hash()));
+  indexFileName.Append("_eventIndex.root");
+  return indexFileName;
+}
+
+/*
+ * Identity of a forest file stored in the index. A ROOT file is identified by its UUID, which is different
+ * for each written file, and its size. A mapped forest has no UUID, so its size and modification time are used.
+ *
+ *  Arguments:
+ *   TFile *inputFile = File containing the forest. NULL for mapped forest files.
+ *   const TString forestFileName = Name of the forest file
+ *
+ *   return: Identity of the forest file
+ */
+TString EventSelectionIndex::GetForestIdentity(TFile *inputFile, const TString forestFileName){
+  if(inputFile) return Form("UUID %s size %lld", inputFile->GetUUID().AsString(), inputFile->GetSize());
+
+  FileStat_t fileStat;
+  if(gSystem->GetPathInfo(forestFileName.Data(), fileStat) != 0){
+    cout << "Error! Could not find the forest file " << forestFileName.Data() << endl;
+    assert(0);
+  }
+  return Form("size %lld modified %ld", fileStat.fSize, fileStat.fMtime);
+}
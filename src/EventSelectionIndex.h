@@ -0,0 +1,73 @@
+// Class for the event selection index stored next to the forest files
+//
+//===========================================================
+// EventSelectionIndex.h
+//
+// The index contains the event level information needed by the event cuts for all the events in
+// one forest file. It is written to a small sidecar file the first time the forest is analyzed.
+// In the following runs the event cuts are applied directly to the index, such that only the
+// events passing the cuts need to be read from the forest. The index stores an identity of the
+// forest file it was made for, and an index made for a different file is never used.
+//===========================================================
+
+#ifndef EVENTSELECTIONINDEX_H
+#define EVENTSELECTIONINDEX_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <assert.h>
+
+// Root includes
+#include <TString.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TDirectory.h>
+#include <TNamed.h>
+
+// Own includes
+#include "ForestReader.h"
+
+using namespace std;
+
+class EventSelectionIndex{
+
+public:
+
+  // Event level information used by the event cuts
+  struct EventInformation{
+    Float_t fVertexZ;                     // Vertex z-position
+    Int_t fHiBin;                         // HiBin = Centrality percentile * 2
+    Float_t fPtHat;                       // pT hat
+    Float_t fEventWeight;                 // Event weight in MC
+    Int_t fJetFilterBit;                  // Filter bit for the jet trigger
+    Int_t fPrimaryVertexFilterBit;        // Filter bit for primary vertex
+    Int_t fBeamScrapingFilterBit;         // Filter bit for beam scraping
+    Int_t fHfCoincidenceFilterBit;        // Filter bit for energy recorded in at least 3 HF calorimeter towers
+    Int_t fClusterCompatibilityFilterBit; // Filter bit for cluster compatibility
+  };
+
+  // Constructors and destructor
+  EventSelectionIndex();                                          // Default constructor
+  EventSelectionIndex(const EventSelectionIndex& in);             // Copy constructor
+  ~EventSelectionIndex();                                         // Destructor
+  EventSelectionIndex& operator=(const EventSelectionIndex& obj); // Equal sign operator
+
+  // Methods
+  Bool_t ReadIndex(const char *indexFileName, const Long64_t nEvents, const TString description, const TString forestIdentity); // Read the index from a sidecar file
+  void BuildIndex(ForestReader *eventReader);                      // Read the event level information of all events from the forest
+  void WriteIndex(const char *indexFileName, const TString description, const TString forestIdentity) const; // Write the index to a sidecar file
+  Long64_t GetNEvents() const;                                     // Getter for the number of events in the index
+  const EventInformation& GetEventInformation(const Long64_t iEvent) const; // Getter for the event level information of one event
+
+  static EventInformation ReadEventInformation(const ForestReader *eventReader); // Collect the event level information of the current event from a reader
+  static TString GetIndexFileName(const TString forestFileName);   // Name of the sidecar file for a forest file
+  static TString GetForestIdentity(TFile *inputFile, const TString forestFileName); // Identity of a forest file stored in the index
+
+private:
+
+  std::vector<EventInformation> fEvents; // Event level information for all the events in the forest
+
+};
+
+#endif
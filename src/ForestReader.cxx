@@ -12,12 +12,21 @@ ForestReader::ForestReader() :
   fJetAxis(0),
   fUseTrigger(false),
   fIsMiniAOD(false),
+  fIsSlimForest(false),
+  fIsMappedForest(false),
+  fMappedForest(0),
+  fCurrentEvent(-1),
+  fReadTrackColumnsOnDemand(false),
+  fTreeCacheSize(0),
+  fAsyncPrefetch(false),
+  fNumberOfThreads(1),
   fHeavyIonTree(0),
   fJetTree(0),
   fHltTree(0),
   fSkimTree(0),
   fTrackTree(0),
   fGenParticleTree(0),
+  fSlimForestTree(0),
   fHiVzBranch(0),
   fHiBinBranch(0),
   fPtHatBranch(0),
@@ -64,34 +73,38 @@ ForestReader::ForestReader() :
   fnJets(0),
   fnGenJets(0),
   fEventWeight(1),
-  fJetPtArray(),
-  fJetPhiArray(),
-  fJetEtaArray(),
-  fJetRawPtArray(),
-  fGenJetPtArray(),
-  fGenJetPhiArray(),
-  fGenJetEtaArray(),
+  fJetBufferSize(0),
+  fJetPtArray(0),
+  fJetPhiArray(0),
+  fJetEtaArray(0),
+  fJetRawPtArray(0),
+  fJetMaxTrackPtArray(0),
+  fGenJetPtArray(0),
+  fGenJetPhiArray(0),
+  fGenJetEtaArray(0),
   fJetFilterBit(1),
   fPrimaryVertexFilterBit(0),
   fBeamScrapingFilterBit(0),
   fHfCoincidenceFilterBit(0),
   fClusterCompatibilityFilterBit(0),
   fnTracks(0),
-  fTrackPtArray(),
-  fTrackPtErrorArray(),
-  fTrackPhiArray(),
-  fTrackEtaArray(),
-  fHighPurityTrackArray(),
-  fTrackVertexDistanceZArray(),
-  fTrackVertexDistanceZErrorArray(),
-  fTrackVertexDistanceXYArray(),
-  fTrackVertexDistanceXYErrorArray(),
-  fTrackChi2Array(),
-  fnTrackDegreesOfFreedomArray(),
-  fnHitsTrackerLayerArray(),
-  fnHitsTrackArray(),
-  fTrackEnergyEcalArray(),
-  fTrackEnergyHcalArray(),
+  fTrackBufferSize(0),
+  fTrackPtArray(0),
+  fTrackPtErrorArray(0),
+  fTrackPhiArray(0),
+  fTrackEtaArray(0),
+  fHighPurityTrackArray(0),
+  fTrackVertexDistanceZArray(0),
+  fTrackVertexDistanceZErrorArray(0),
+  fTrackVertexDistanceXYArray(0),
+  fTrackVertexDistanceXYErrorArray(0),
+  fTrackChi2Array(0),
+  fTrackNormalizedChi2Array(0),
+  fnTrackDegreesOfFreedomArray(0),
+  fnHitsTrackerLayerArray(0),
+  fnHitsTrackArray(0),
+  fTrackEnergyEcalArray(0),
+  fTrackEnergyHcalArray(0),
   fTrackPtVector(0),
   fTrackPtErrorVector(0),
   fTrackPhiVector(0),
@@ -106,6 +119,8 @@ ForestReader::ForestReader() :
   fnHitsTrackVector(0),
   fTrackEnergyEcalVector(0),
   fTrackEnergyHcalVector(0),
+  fNormalizedChi2Ready(false),
+  fnTrackEventsRead(0),
   fnGenParticles(0),
   fGenParticlePtArray(0),
   fGenParticlePhiArray(0),
@@ -115,9 +130,25 @@ ForestReader::ForestReader() :
 {
   // Default constructor
   
-  // Initialize fJetMaxTrackPtArray to -1
-  for(Int_t i = 0; i < fnMaxJet; i++){
-    fJetMaxTrackPtArray[i] = -1;
+  // Allocate the initial event buffers. They grow when larger events are read.
+  AllocateJetBuffers(fnInitialJets);
+  AllocateTrackBuffers(fnInitialTracks);
+  
+  // Point the event view to the branch buffers
+  ResetEventView();
+  
+  // Initialize the track column bookkeeping
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    fTrackColumnBranches[iColumn] = 0;
+    fTrackColumnLoaded[iColumn] = false;
+    fTrackColumnBytesRead[iColumn] = 0;
+    fTrackColumnEntriesRead[iColumn] = 0;
+  }
+  
+  // Initialize the decompression statistics
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    fTreePerfStats[iTree] = 0;
+    fTreeUnzipTime[iTree] = 0;
   }
   
 }
@@ -137,12 +168,21 @@ ForestReader::ForestReader(Int_t dataType, Int_t jetType, Int_t jetAxis, Bool_t
   fJetAxis(jetAxis),
   fUseTrigger(useTrigger),
   fIsMiniAOD(false),
+  fIsSlimForest(false),
+  fIsMappedForest(false),
+  fMappedForest(0),
+  fCurrentEvent(-1),
+  fReadTrackColumnsOnDemand(false),
+  fTreeCacheSize(0),
+  fAsyncPrefetch(false),
+  fNumberOfThreads(1),
   fHeavyIonTree(0),
   fJetTree(0),
   fHltTree(0),
   fSkimTree(0),
   fTrackTree(0),
   fGenParticleTree(0),
+  fSlimForestTree(0),
   fHiVzBranch(0),
   fHiBinBranch(0),
   fPtHatBranch(0),
@@ -189,34 +229,38 @@ ForestReader::ForestReader(Int_t dataType, Int_t jetType, Int_t jetAxis, Bool_t
   fnJets(0),
   fnGenJets(0),
   fEventWeight(1),
-  fJetPtArray(),
-  fJetPhiArray(),
-  fJetEtaArray(),
-  fJetRawPtArray(),
-  fGenJetPtArray(),
-  fGenJetPhiArray(),
-  fGenJetEtaArray(),
+  fJetBufferSize(0),
+  fJetPtArray(0),
+  fJetPhiArray(0),
+  fJetEtaArray(0),
+  fJetRawPtArray(0),
+  fJetMaxTrackPtArray(0),
+  fGenJetPtArray(0),
+  fGenJetPhiArray(0),
+  fGenJetEtaArray(0),
   fJetFilterBit(1),
   fPrimaryVertexFilterBit(0),
   fBeamScrapingFilterBit(0),
   fHfCoincidenceFilterBit(0),
   fClusterCompatibilityFilterBit(0),
   fnTracks(0),
-  fTrackPtArray(),
-  fTrackPtErrorArray(),
-  fTrackPhiArray(),
-  fTrackEtaArray(),
-  fHighPurityTrackArray(),
-  fTrackVertexDistanceZArray(),
-  fTrackVertexDistanceZErrorArray(),
-  fTrackVertexDistanceXYArray(),
-  fTrackVertexDistanceXYErrorArray(),
-  fTrackChi2Array(),
-  fnTrackDegreesOfFreedomArray(),
-  fnHitsTrackerLayerArray(),
-  fnHitsTrackArray(),
-  fTrackEnergyEcalArray(),
-  fTrackEnergyHcalArray(),
+  fTrackBufferSize(0),
+  fTrackPtArray(0),
+  fTrackPtErrorArray(0),
+  fTrackPhiArray(0),
+  fTrackEtaArray(0),
+  fHighPurityTrackArray(0),
+  fTrackVertexDistanceZArray(0),
+  fTrackVertexDistanceZErrorArray(0),
+  fTrackVertexDistanceXYArray(0),
+  fTrackVertexDistanceXYErrorArray(0),
+  fTrackChi2Array(0),
+  fTrackNormalizedChi2Array(0),
+  fnTrackDegreesOfFreedomArray(0),
+  fnHitsTrackerLayerArray(0),
+  fnHitsTrackArray(0),
+  fTrackEnergyEcalArray(0),
+  fTrackEnergyHcalArray(0),
   fTrackPtVector(0),
   fTrackPtErrorVector(0),
   fTrackPhiVector(0),
@@ -231,6 +275,8 @@ ForestReader::ForestReader(Int_t dataType, Int_t jetType, Int_t jetAxis, Bool_t
   fnHitsTrackVector(0),
   fTrackEnergyEcalVector(0),
   fTrackEnergyHcalVector(0),
+  fNormalizedChi2Ready(false),
+  fnTrackEventsRead(0),
   fnGenParticles(0),
   fGenParticlePtArray(0),
   fGenParticlePhiArray(0),
@@ -242,9 +288,25 @@ ForestReader::ForestReader(Int_t dataType, Int_t jetType, Int_t jetAxis, Bool_t
   
   SetDataType(dataType);
   
-  // Initialize fJetMaxTrackPtArray to -1
-  for(int i = 0; i < fnMaxJet; i++){
-    fJetMaxTrackPtArray[i] = -1;
+  // Allocate the initial event buffers. They grow when larger events are read.
+  AllocateJetBuffers(fnInitialJets);
+  AllocateTrackBuffers(fnInitialTracks);
+  
+  // Point the event view to the branch buffers
+  ResetEventView();
+  
+  // Initialize the track column bookkeeping
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    fTrackColumnBranches[iColumn] = 0;
+    fTrackColumnLoaded[iColumn] = false;
+    fTrackColumnBytesRead[iColumn] = 0;
+    fTrackColumnEntriesRead[iColumn] = 0;
+  }
+  
+  // Initialize the decompression statistics
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    fTreePerfStats[iTree] = 0;
+    fTreeUnzipTime[iTree] = 0;
   }
   
 }
@@ -258,12 +320,21 @@ ForestReader::ForestReader(const ForestReader& in) :
   fJetAxis(in.fJetAxis),
   fUseTrigger(in.fUseTrigger),
   fIsMiniAOD(in.fIsMiniAOD),
+  fIsSlimForest(in.fIsSlimForest),
+  fIsMappedForest(in.fIsMappedForest),
+  fMappedForest(in.fMappedForest ? new MappedForestFile(*in.fMappedForest) : 0),
+  fCurrentEvent(in.fCurrentEvent),
+  fReadTrackColumnsOnDemand(in.fReadTrackColumnsOnDemand),
+  fTreeCacheSize(in.fTreeCacheSize),
+  fAsyncPrefetch(in.fAsyncPrefetch),
+  fNumberOfThreads(in.fNumberOfThreads),
   fHeavyIonTree(in.fHeavyIonTree),
   fJetTree(in.fJetTree),
   fHltTree(in.fHltTree),
   fSkimTree(in.fSkimTree),
   fTrackTree(in.fTrackTree),
   fGenParticleTree(in.fGenParticleTree),
+  fSlimForestTree(in.fSlimForestTree),
   fHiVzBranch(in.fHiVzBranch),
   fHiBinBranch(in.fHiBinBranch),
   fPtHatBranch(in.fPtHatBranch),
@@ -310,12 +381,38 @@ ForestReader::ForestReader(const ForestReader& in) :
   fnJets(in.fnJets),
   fnGenJets(in.fnGenJets),
   fEventWeight(in.fEventWeight),
+  fJetBufferSize(0),
+  fJetPtArray(0),
+  fJetPhiArray(0),
+  fJetEtaArray(0),
+  fJetRawPtArray(0),
+  fJetMaxTrackPtArray(0),
+  fGenJetPtArray(0),
+  fGenJetPhiArray(0),
+  fGenJetEtaArray(0),
   fJetFilterBit(in.fJetFilterBit),
   fPrimaryVertexFilterBit(in.fPrimaryVertexFilterBit),
   fBeamScrapingFilterBit(in.fBeamScrapingFilterBit),
   fHfCoincidenceFilterBit(in.fHfCoincidenceFilterBit),
   fClusterCompatibilityFilterBit(in.fClusterCompatibilityFilterBit),
   fnTracks(in.fnTracks),
+  fTrackBufferSize(0),
+  fTrackPtArray(0),
+  fTrackPtErrorArray(0),
+  fTrackPhiArray(0),
+  fTrackEtaArray(0),
+  fHighPurityTrackArray(0),
+  fTrackVertexDistanceZArray(0),
+  fTrackVertexDistanceZErrorArray(0),
+  fTrackVertexDistanceXYArray(0),
+  fTrackVertexDistanceXYErrorArray(0),
+  fTrackChi2Array(0),
+  fTrackNormalizedChi2Array(0),
+  fnTrackDegreesOfFreedomArray(0),
+  fnHitsTrackerLayerArray(0),
+  fnHitsTrackArray(0),
+  fTrackEnergyEcalArray(0),
+  fTrackEnergyHcalArray(0),
   fTrackPtVector(in.fTrackPtVector),
   fTrackPhiVector(in.fTrackPhiVector),
   fTrackEtaVector(in.fTrackEtaVector),
@@ -329,6 +426,8 @@ ForestReader::ForestReader(const ForestReader& in) :
   fnHitsTrackVector(in.fnHitsTrackVector),
   fTrackEnergyEcalVector(in.fTrackEnergyEcalVector),
   fTrackEnergyHcalVector(in.fTrackEnergyHcalVector),
+  fNormalizedChi2Ready(false),
+  fnTrackEventsRead(in.fnTrackEventsRead),
   fnGenParticles(in.fnGenParticles),
   fGenParticlePtArray(in.fGenParticlePtArray),
   fGenParticlePhiArray(in.fGenParticlePhiArray),
@@ -338,35 +437,53 @@ ForestReader::ForestReader(const ForestReader& in) :
 {
   // Copy constructor
   
-  for(Int_t i = 0; i < fnMaxJet; i++){
-    fJetPtArray[i] = in.fJetPtArray[i];
-    fJetPhiArray[i] = in.fJetPhiArray[i];
-    fJetEtaArray[i] = in.fJetEtaArray[i];
-    fJetRawPtArray[i] = in.fJetRawPtArray[i];
-    fJetMaxTrackPtArray[i] = in.fJetMaxTrackPtArray[i];
-    fGenJetPtArray[i] = in.fGenJetPtArray[i];
-    fGenJetPhiArray[i] = in.fGenJetPhiArray[i];
-    fGenJetEtaArray[i] = in.fGenJetEtaArray[i];
+  // Allocate own buffers of the same size and copy the jets and tracks of the current event
+  AllocateJetBuffers(in.fJetBufferSize);
+  std::copy(in.fJetPtArray, in.fJetPtArray + fJetBufferSize, fJetPtArray);
+  std::copy(in.fJetPhiArray, in.fJetPhiArray + fJetBufferSize, fJetPhiArray);
+  std::copy(in.fJetEtaArray, in.fJetEtaArray + fJetBufferSize, fJetEtaArray);
+  std::copy(in.fJetRawPtArray, in.fJetRawPtArray + fJetBufferSize, fJetRawPtArray);
+  std::copy(in.fJetMaxTrackPtArray, in.fJetMaxTrackPtArray + fJetBufferSize, fJetMaxTrackPtArray);
+  std::copy(in.fGenJetPtArray, in.fGenJetPtArray + fJetBufferSize, fGenJetPtArray);
+  std::copy(in.fGenJetPhiArray, in.fGenJetPhiArray + fJetBufferSize, fGenJetPhiArray);
+  std::copy(in.fGenJetEtaArray, in.fGenJetEtaArray + fJetBufferSize, fGenJetEtaArray);
+  
+  AllocateTrackBuffers(in.fTrackBufferSize);
+  std::copy(in.fTrackPtArray, in.fTrackPtArray + fTrackBufferSize, fTrackPtArray);
+  std::copy(in.fTrackPtErrorArray, in.fTrackPtErrorArray + fTrackBufferSize, fTrackPtErrorArray);
+  std::copy(in.fTrackPhiArray, in.fTrackPhiArray + fTrackBufferSize, fTrackPhiArray);
+  std::copy(in.fTrackEtaArray, in.fTrackEtaArray + fTrackBufferSize, fTrackEtaArray);
+  std::copy(in.fHighPurityTrackArray, in.fHighPurityTrackArray + fTrackBufferSize, fHighPurityTrackArray);
+  std::copy(in.fTrackVertexDistanceZArray, in.fTrackVertexDistanceZArray + fTrackBufferSize, fTrackVertexDistanceZArray);
+  std::copy(in.fTrackVertexDistanceZErrorArray, in.fTrackVertexDistanceZErrorArray + fTrackBufferSize, fTrackVertexDistanceZErrorArray);
+  std::copy(in.fTrackVertexDistanceXYArray, in.fTrackVertexDistanceXYArray + fTrackBufferSize, fTrackVertexDistanceXYArray);
+  std::copy(in.fTrackVertexDistanceXYErrorArray, in.fTrackVertexDistanceXYErrorArray + fTrackBufferSize, fTrackVertexDistanceXYErrorArray);
+  std::copy(in.fTrackChi2Array, in.fTrackChi2Array + fTrackBufferSize, fTrackChi2Array);
+  std::copy(in.fTrackNormalizedChi2Array, in.fTrackNormalizedChi2Array + fTrackBufferSize, fTrackNormalizedChi2Array);
+  std::copy(in.fnTrackDegreesOfFreedomArray, in.fnTrackDegreesOfFreedomArray + fTrackBufferSize, fnTrackDegreesOfFreedomArray);
+  std::copy(in.fnHitsTrackerLayerArray, in.fnHitsTrackerLayerArray + fTrackBufferSize, fnHitsTrackerLayerArray);
+  std::copy(in.fnHitsTrackArray, in.fnHitsTrackArray + fTrackBufferSize, fnHitsTrackArray);
+  std::copy(in.fTrackEnergyEcalArray, in.fTrackEnergyEcalArray + fTrackBufferSize, fTrackEnergyEcalArray);
+  std::copy(in.fTrackEnergyHcalArray, in.fTrackEnergyHcalArray + fTrackBufferSize, fTrackEnergyHcalArray);
+  
+  // Copy the track column bookkeeping
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    fTrackColumnBranches[iColumn] = in.fTrackColumnBranches[iColumn];
+    fTrackColumnLoaded[iColumn] = in.fTrackColumnLoaded[iColumn];
+    fTrackColumnBytesRead[iColumn] = in.fTrackColumnBytesRead[iColumn];
+    fTrackColumnEntriesRead[iColumn] = in.fTrackColumnEntriesRead[iColumn];
   }
   
-  // Copy the track arrays
-  for(Int_t i = 0; i < fnMaxTrack; i++){
-    fTrackPtArray[i] = in.fTrackPtArray[i];
-    fTrackPtErrorArray[i] = in.fTrackPtErrorArray[i];
-    fTrackPhiArray[i] = in.fTrackPhiArray[i];
-    fTrackEtaArray[i] = in.fTrackEtaArray[i];
-    fHighPurityTrackArray[i] = in.fHighPurityTrackArray[i];
-    fTrackVertexDistanceZArray[i] = in.fTrackVertexDistanceZArray[i];
-    fTrackVertexDistanceZErrorArray[i] = in.fTrackVertexDistanceZErrorArray[i];
-    fTrackVertexDistanceXYArray[i] = in.fTrackVertexDistanceXYArray[i];
-    fTrackVertexDistanceXYErrorArray[i] = in.fTrackVertexDistanceXYErrorArray[i];
-    fTrackChi2Array[i] = in.fTrackChi2Array[i];
-    fnTrackDegreesOfFreedomArray[i] = in.fnTrackDegreesOfFreedomArray[i];
-    fnHitsTrackerLayerArray[i] = in.fnHitsTrackerLayerArray[i];
-    fnHitsTrackArray[i] = in.fnHitsTrackArray[i];
-    fTrackEnergyEcalArray[i] = in.fTrackEnergyEcalArray[i];
-    fTrackEnergyHcalArray[i] = in.fTrackEnergyHcalArray[i];
+  // The decompression statistics of the connected trees are owned by the reader that connected them
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    fTreePerfStats[iTree] = 0;
+    fTreeUnzipTime[iTree] = in.fTreeUnzipTime[iTree];
   }
+  fSlimEventBranches = in.fSlimEventBranches;
+  fSlimContentBranches = in.fSlimContentBranches;
+  
+  // Point the event view to the own buffers of this reader
+  ResetEventView();
 }
 
 /*
@@ -377,17 +494,30 @@ ForestReader& ForestReader::operator=(const ForestReader& in){
   
   if (&in==this) return *this;
   
+  // Detach the own decompression statistics from the previous trees before the trees are replaced
+  CollectTreeUnzipTimes();
+  
   fDataType = in.fDataType;
   fJetType = in.fJetType;
   fJetAxis = in.fJetAxis;
   fUseTrigger = in.fUseTrigger;
   fIsMiniAOD = in.fIsMiniAOD;
+  fIsSlimForest = in.fIsSlimForest;
+  fIsMappedForest = in.fIsMappedForest;
+  delete fMappedForest;
+  fMappedForest = in.fMappedForest ? new MappedForestFile(*in.fMappedForest) : 0;
+  fCurrentEvent = in.fCurrentEvent;
+  fReadTrackColumnsOnDemand = in.fReadTrackColumnsOnDemand;
+  fTreeCacheSize = in.fTreeCacheSize;
+  fAsyncPrefetch = in.fAsyncPrefetch;
+  fNumberOfThreads = in.fNumberOfThreads;
   fHeavyIonTree = in.fHeavyIonTree;
   fJetTree = in.fJetTree;
   fHltTree = in.fHltTree;
   fSkimTree = in.fSkimTree;
   fTrackTree = in.fTrackTree;
   fGenParticleTree = in.fGenParticleTree;
+  fSlimForestTree = in.fSlimForestTree;
   fHiVzBranch = in.fHiVzBranch;
   fHiBinBranch = in.fHiBinBranch;
   fPtHatBranch = in.fPtHatBranch;
@@ -441,39 +571,38 @@ ForestReader& ForestReader::operator=(const ForestReader& in){
   fClusterCompatibilityFilterBit = in.fClusterCompatibilityFilterBit;
   fnTracks = in.fnTracks;
   
-  for(Int_t i = 0; i < fnMaxJet; i++){
-    fJetPtArray[i] = in.fJetPtArray[i];
-    fJetPhiArray[i] = in.fJetPhiArray[i];
-    fJetEtaArray[i] = in.fJetEtaArray[i];
-    fJetRawPtArray[i] = in.fJetRawPtArray[i];
-    fJetMaxTrackPtArray[i] = in.fJetMaxTrackPtArray[i];
-    fGenJetPtArray[i] = in.fGenJetPtArray[i];
-    fGenJetPhiArray[i] = in.fGenJetPhiArray[i];
-    fGenJetEtaArray[i] = in.fGenJetEtaArray[i];
-  }
+  // Allocate own buffers of the same size and copy the jets and tracks of the current event
+  AllocateJetBuffers(in.fJetBufferSize);
+  std::copy(in.fJetPtArray, in.fJetPtArray + fJetBufferSize, fJetPtArray);
+  std::copy(in.fJetPhiArray, in.fJetPhiArray + fJetBufferSize, fJetPhiArray);
+  std::copy(in.fJetEtaArray, in.fJetEtaArray + fJetBufferSize, fJetEtaArray);
+  std::copy(in.fJetRawPtArray, in.fJetRawPtArray + fJetBufferSize, fJetRawPtArray);
+  std::copy(in.fJetMaxTrackPtArray, in.fJetMaxTrackPtArray + fJetBufferSize, fJetMaxTrackPtArray);
+  std::copy(in.fGenJetPtArray, in.fGenJetPtArray + fJetBufferSize, fGenJetPtArray);
+  std::copy(in.fGenJetPhiArray, in.fGenJetPhiArray + fJetBufferSize, fGenJetPhiArray);
+  std::copy(in.fGenJetEtaArray, in.fGenJetEtaArray + fJetBufferSize, fGenJetEtaArray);
   
-  // Copy the track arrays
-  for(Int_t i = 0; i < fnMaxTrack; i++){
-    fTrackPtArray[i] = in.fTrackPtArray[i];
-    fTrackPtErrorArray[i] = in.fTrackPtErrorArray[i];
-    fTrackPhiArray[i] = in.fTrackPhiArray[i];
-    fTrackEtaArray[i] = in.fTrackEtaArray[i];
-    fHighPurityTrackArray[i] = in.fHighPurityTrackArray[i];
-    fTrackVertexDistanceZArray[i] = in.fTrackVertexDistanceZArray[i];
-    fTrackVertexDistanceZErrorArray[i] = in.fTrackVertexDistanceZErrorArray[i];
-    fTrackVertexDistanceXYArray[i] = in.fTrackVertexDistanceXYArray[i];
-    fTrackVertexDistanceXYErrorArray[i] = in.fTrackVertexDistanceXYErrorArray[i];
-    fTrackChi2Array[i] = in.fTrackChi2Array[i];
-    fnTrackDegreesOfFreedomArray[i] = in.fnTrackDegreesOfFreedomArray[i];
-    fnHitsTrackerLayerArray[i] = in.fnHitsTrackerLayerArray[i];
-    fnHitsTrackArray[i] = in.fnHitsTrackArray[i];
-    fTrackEnergyEcalArray[i] = in.fTrackEnergyEcalArray[i];
-    fTrackEnergyHcalArray[i] = in.fTrackEnergyHcalArray[i];
-  }
+  AllocateTrackBuffers(in.fTrackBufferSize);
+  std::copy(in.fTrackPtArray, in.fTrackPtArray + fTrackBufferSize, fTrackPtArray);
+  std::copy(in.fTrackPtErrorArray, in.fTrackPtErrorArray + fTrackBufferSize, fTrackPtErrorArray);
+  std::copy(in.fTrackPhiArray, in.fTrackPhiArray + fTrackBufferSize, fTrackPhiArray);
+  std::copy(in.fTrackEtaArray, in.fTrackEtaArray + fTrackBufferSize, fTrackEtaArray);
+  std::copy(in.fHighPurityTrackArray, in.fHighPurityTrackArray + fTrackBufferSize, fHighPurityTrackArray);
+  std::copy(in.fTrackVertexDistanceZArray, in.fTrackVertexDistanceZArray + fTrackBufferSize, fTrackVertexDistanceZArray);
+  std::copy(in.fTrackVertexDistanceZErrorArray, in.fTrackVertexDistanceZErrorArray + fTrackBufferSize, fTrackVertexDistanceZErrorArray);
+  std::copy(in.fTrackVertexDistanceXYArray, in.fTrackVertexDistanceXYArray + fTrackBufferSize, fTrackVertexDistanceXYArray);
+  std::copy(in.fTrackVertexDistanceXYErrorArray, in.fTrackVertexDistanceXYErrorArray + fTrackBufferSize, fTrackVertexDistanceXYErrorArray);
+  std::copy(in.fTrackChi2Array, in.fTrackChi2Array + fTrackBufferSize, fTrackChi2Array);
+  std::copy(in.fTrackNormalizedChi2Array, in.fTrackNormalizedChi2Array + fTrackBufferSize, fTrackNormalizedChi2Array);
+  std::copy(in.fnTrackDegreesOfFreedomArray, in.fnTrackDegreesOfFreedomArray + fTrackBufferSize, fnTrackDegreesOfFreedomArray);
+  std::copy(in.fnHitsTrackerLayerArray, in.fnHitsTrackerLayerArray + fTrackBufferSize, fnHitsTrackerLayerArray);
+  std::copy(in.fnHitsTrackArray, in.fnHitsTrackArray + fTrackBufferSize, fnHitsTrackArray);
+  std::copy(in.fTrackEnergyEcalArray, in.fTrackEnergyEcalArray + fTrackBufferSize, fTrackEnergyEcalArray);
+  std::copy(in.fTrackEnergyHcalArray, in.fTrackEnergyHcalArray + fTrackBufferSize, fTrackEnergyHcalArray);
   
   // Copy the track vectors
   fTrackPtVector = in.fTrackPtVector;
-  fTrackPtVector = in.fTrackPtVector;
+  fTrackPtErrorVector = in.fTrackPtErrorVector;
   fTrackPhiVector = in.fTrackPhiVector;
   fTrackEtaVector = in.fTrackEtaVector;
   fHighPurityTrackVector = in.fHighPurityTrackVector;
@@ -487,6 +616,26 @@ ForestReader& ForestReader::operator=(const ForestReader& in){
   fTrackEnergyEcalVector = in.fTrackEnergyEcalVector;
   fTrackEnergyHcalVector = in.fTrackEnergyHcalVector;
   
+  // Copy the track column bookkeeping
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    fTrackColumnBranches[iColumn] = in.fTrackColumnBranches[iColumn];
+    fTrackColumnLoaded[iColumn] = in.fTrackColumnLoaded[iColumn];
+    fTrackColumnBytesRead[iColumn] = in.fTrackColumnBytesRead[iColumn];
+    fTrackColumnEntriesRead[iColumn] = in.fTrackColumnEntriesRead[iColumn];
+  }
+  
+  // The decompression statistics of the connected trees are owned by the reader that connected them
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    fTreeUnzipTime[iTree] = in.fTreeUnzipTime[iTree];
+  }
+  fnTrackEventsRead = in.fnTrackEventsRead;
+  fNormalizedChi2Ready = false;
+  fSlimEventBranches = in.fSlimEventBranches;
+  fSlimContentBranches = in.fSlimContentBranches;
+  
+  // Point the event view to the own buffers of this reader
+  ResetEventView();
+  
   // Copy the generator level particle vectors
   fnGenParticles = in.fnGenParticles;
   fGenParticlePtArray = in.fGenParticlePtArray;
@@ -502,7 +651,16 @@ ForestReader& ForestReader::operator=(const ForestReader& in){
  * Destructor
  */
 ForestReader::~ForestReader(){
-  // destructor
+  
+  // Unmap the mapped forest
+  delete fMappedForest;
+  
+  // Detach and delete the decompression statistics. The forest must have been disconnected if its file is closed.
+  CollectTreeUnzipTimes();
+  
+  // Delete the event buffers
+  AllocateJetBuffers(0);
+  AllocateTrackBuffers(0);
 }
 
 /*
@@ -533,39 +691,39 @@ void ForestReader::Initialize(){
   
   fJetTree->SetBranchStatus("*",0);
   fJetTree->SetBranchStatus("jtpt",1);
-  fJetTree->SetBranchAddress("jtpt",&fJetPtArray,&fJetPtBranch);
+  fJetTree->SetBranchAddress("jtpt",fJetPtArray,&fJetPtBranch);
   
   // If specified, select WTA axis for jet phi
   branchName = Form("%sphi",jetAxis[fJetAxis]);
   fJetTree->SetBranchStatus(branchName,1);
-  fJetTree->SetBranchAddress(branchName,&fJetPhiArray,&fJetPhiBranch);
+  fJetTree->SetBranchAddress(branchName,fJetPhiArray,&fJetPhiBranch);
   
   // If specified, select WTA axis for jet eta
   branchName = Form("%seta",jetAxis[fJetAxis]);
   fJetTree->SetBranchStatus(branchName,1);
-  fJetTree->SetBranchAddress(branchName,&fJetEtaArray,&fJetEtaBranch);
+  fJetTree->SetBranchAddress(branchName,fJetEtaArray,&fJetEtaBranch);
   
   fJetTree->SetBranchStatus("nref",1);
   fJetTree->SetBranchAddress("nref",&fnJets,&fnJetsBranch);
   fJetTree->SetBranchStatus("rawpt",1);
-  fJetTree->SetBranchAddress("rawpt",&fJetRawPtArray,&fJetRawPtBranch);
+  fJetTree->SetBranchAddress("rawpt",fJetRawPtArray,&fJetRawPtBranch);
   fJetTree->SetBranchStatus("trackMax",1);
-  fJetTree->SetBranchAddress("trackMax",&fJetMaxTrackPtArray,&fJetMaxTrackPtBranch);
+  fJetTree->SetBranchAddress("trackMax",fJetMaxTrackPtArray,&fJetMaxTrackPtBranch);
   
   // If we are looking at Monte Carlo, connect the reference pT and parton arrays
   if(fDataType > kPbPb){
     fJetTree->SetBranchStatus("genpt",1);
-    fJetTree->SetBranchAddress("genpt",&fGenJetPtArray,&fGenJetPtBranch);
+    fJetTree->SetBranchAddress("genpt",fGenJetPtArray,&fGenJetPtBranch);
     
     // If specified, select WTA axis for jet phi
     branchName = Form("%sgenphi",genJetAxis[fJetAxis]);
     fJetTree->SetBranchStatus(branchName,1);
-    fJetTree->SetBranchAddress(branchName,&fGenJetPhiArray,&fGenJetPhiBranch);
+    fJetTree->SetBranchAddress(branchName,fGenJetPhiArray,&fGenJetPhiBranch);
     
     // If specified, select WTA axis for jet eta
     branchName = Form("%sgeneta",genJetAxis[fJetAxis]);
     fJetTree->SetBranchStatus(branchName,1);
-    fJetTree->SetBranchAddress(branchName,&fGenJetEtaArray,&fGenJetEtaBranch);
+    fJetTree->SetBranchAddress(branchName,fGenJetEtaArray,&fGenJetEtaBranch);
     
     fJetTree->SetBranchStatus("ngen",1);
     fJetTree->SetBranchAddress("ngen",&fnGenJets,&fnGenJetsBranch);
@@ -677,37 +835,37 @@ void ForestReader::Initialize(){
   } else { // Read the tree from AOD files
     
     fTrackTree->SetBranchStatus("trkPt",1);
-    fTrackTree->SetBranchAddress("trkPt",&fTrackPtArray,&fTrackPtBranch);
+    fTrackTree->SetBranchAddress("trkPt",fTrackPtArray,&fTrackPtBranch);
     fTrackTree->SetBranchStatus("trkPtError",1);
-    fTrackTree->SetBranchAddress("trkPtError",&fTrackPtErrorArray,&fTrackPtErrorBranch);
+    fTrackTree->SetBranchAddress("trkPtError",fTrackPtErrorArray,&fTrackPtErrorBranch);
     fTrackTree->SetBranchStatus("trkPhi",1);
-    fTrackTree->SetBranchAddress("trkPhi",&fTrackPhiArray,&fTrackPhiBranch);
+    fTrackTree->SetBranchAddress("trkPhi",fTrackPhiArray,&fTrackPhiBranch);
     fTrackTree->SetBranchStatus("trkEta",1);
-    fTrackTree->SetBranchAddress("trkEta",&fTrackEtaArray,&fTrackEtaBranch);
+    fTrackTree->SetBranchAddress("trkEta",fTrackEtaArray,&fTrackEtaBranch);
     fTrackTree->SetBranchStatus("nTrk",1);
     fTrackTree->SetBranchAddress("nTrk",&fnTracks,&fnTracksBranch);
     fTrackTree->SetBranchStatus("highPurity",1);
-    fTrackTree->SetBranchAddress("highPurity",&fHighPurityTrackArray,&fHighPurityTrackBranch);
+    fTrackTree->SetBranchAddress("highPurity",fHighPurityTrackArray,&fHighPurityTrackBranch);
     fTrackTree->SetBranchStatus("trkDz1",1);
-    fTrackTree->SetBranchAddress("trkDz1",&fTrackVertexDistanceZArray,&fTrackVertexDistanceZBranch);
+    fTrackTree->SetBranchAddress("trkDz1",fTrackVertexDistanceZArray,&fTrackVertexDistanceZBranch);
     fTrackTree->SetBranchStatus("trkDzError1",1);
-    fTrackTree->SetBranchAddress("trkDzError1",&fTrackVertexDistanceZErrorArray,&fTrackVertexDistanceZErrorBranch);
+    fTrackTree->SetBranchAddress("trkDzError1",fTrackVertexDistanceZErrorArray,&fTrackVertexDistanceZErrorBranch);
     fTrackTree->SetBranchStatus("trkDxy1",1);
-    fTrackTree->SetBranchAddress("trkDxy1",&fTrackVertexDistanceXYArray,&fTrackVertexDistanceXYBranch);
+    fTrackTree->SetBranchAddress("trkDxy1",fTrackVertexDistanceXYArray,&fTrackVertexDistanceXYBranch);
     fTrackTree->SetBranchStatus("trkDxyError1",1);
-    fTrackTree->SetBranchAddress("trkDxyError1",&fTrackVertexDistanceXYErrorArray,&fTrackVertexDistanceXYErrorBranch);
+    fTrackTree->SetBranchAddress("trkDxyError1",fTrackVertexDistanceXYErrorArray,&fTrackVertexDistanceXYErrorBranch);
     fTrackTree->SetBranchStatus("trkChi2",1);
-    fTrackTree->SetBranchAddress("trkChi2",&fTrackChi2Array,&fTrackChi2Branch);
+    fTrackTree->SetBranchAddress("trkChi2",fTrackChi2Array,&fTrackChi2Branch);
     fTrackTree->SetBranchStatus("trkNdof",1);
-    fTrackTree->SetBranchAddress("trkNdof",&fnTrackDegreesOfFreedomArray,&fnTrackDegreesOfFreedomBranch);
+    fTrackTree->SetBranchAddress("trkNdof",fnTrackDegreesOfFreedomArray,&fnTrackDegreesOfFreedomBranch);
     fTrackTree->SetBranchStatus("trkNlayer",1);
-    fTrackTree->SetBranchAddress("trkNlayer",&fnHitsTrackerLayerArray,&fnHitsTrackerLayerBranch);
+    fTrackTree->SetBranchAddress("trkNlayer",fnHitsTrackerLayerArray,&fnHitsTrackerLayerBranch);
     fTrackTree->SetBranchStatus("trkNHit",1);
-    fTrackTree->SetBranchAddress("trkNHit",&fnHitsTrackArray,&fnHitsTrackBranch);
+    fTrackTree->SetBranchAddress("trkNHit",fnHitsTrackArray,&fnHitsTrackBranch);
     fTrackTree->SetBranchStatus("pfEcal",1);
-    fTrackTree->SetBranchAddress("pfEcal",&fTrackEnergyEcalArray,&fTrackEnergyEcalBranch);
+    fTrackTree->SetBranchAddress("pfEcal",fTrackEnergyEcalArray,&fTrackEnergyEcalBranch);
     fTrackTree->SetBranchStatus("pfHcal",1);
-    fTrackTree->SetBranchAddress("pfHcal",&fTrackEnergyHcalArray,&fTrackEnergyHcalBranch);
+    fTrackTree->SetBranchAddress("pfHcal",fTrackEnergyHcalArray,&fTrackEnergyHcalBranch);
   }
   
   // Connect the branches to the generator level particle tree
@@ -728,6 +886,308 @@ void ForestReader::Initialize(){
 }
 
 
+/*
+ * Connect the branches of a slim forest produced by slimForestConverter. All the information is in a single tree.
+ */
+void ForestReader::InitializeSlimForest(){
+  
+  fSlimEventBranches.clear();
+  fSlimContentBranches.clear();
+  
+  // Event level information
+  fSlimForestTree->SetBranchAddress("vz",&fVertexZ,&fHiVzBranch);
+  fSlimForestTree->SetBranchAddress("hiBin",&fHiBin,&fHiBinBranch);
+  fSlimForestTree->SetBranchAddress("ptHat",&fPtHat,&fPtHatBranch);
+  fSlimForestTree->SetBranchAddress("eventWeight",&fEventWeight,&fEventWeightBranch);
+  fSlimForestTree->SetBranchAddress("primaryVertexFilterBit",&fPrimaryVertexFilterBit,&fPrimaryVertexBranch);
+  fSlimForestTree->SetBranchAddress("beamScrapingFilterBit",&fBeamScrapingFilterBit,&fBeamScrapingBranch);
+  fSlimForestTree->SetBranchAddress("hfCoincidenceFilterBit",&fHfCoincidenceFilterBit,&fHfCoincidenceBranch);
+  fSlimForestTree->SetBranchAddress("clusterCompatibilityFilterBit",&fClusterCompatibilityFilterBit,&fClusterCompatibilityBranch);
+  fSlimEventBranches.push_back(fHiVzBranch);
+  fSlimEventBranches.push_back(fHiBinBranch);
+  fSlimEventBranches.push_back(fPtHatBranch);
+  fSlimEventBranches.push_back(fEventWeightBranch);
+  fSlimEventBranches.push_back(fPrimaryVertexBranch);
+  fSlimEventBranches.push_back(fBeamScrapingBranch);
+  fSlimEventBranches.push_back(fHfCoincidenceBranch);
+  fSlimEventBranches.push_back(fClusterCompatibilityBranch);
+  if(fUseTrigger){
+    fSlimForestTree->SetBranchAddress("jetFilterBit",&fJetFilterBit,&fJetFilterBranch);
+    fSlimEventBranches.push_back(fJetFilterBranch);
+  }
+  
+  // Jets
+  fSlimForestTree->SetBranchAddress("nJets",&fnJets,&fnJetsBranch);
+  fSlimForestTree->SetBranchAddress("jetPt",fJetPtArray,&fJetPtBranch);
+  fSlimForestTree->SetBranchAddress("jetPhi",fJetPhiArray,&fJetPhiBranch);
+  fSlimForestTree->SetBranchAddress("jetEta",fJetEtaArray,&fJetEtaBranch);
+  fSlimForestTree->SetBranchAddress("jetRawPt",fJetRawPtArray,&fJetRawPtBranch);
+  fSlimForestTree->SetBranchAddress("jetMaxTrackPt",fJetMaxTrackPtArray,&fJetMaxTrackPtBranch);
+  fSlimContentBranches.push_back(fnJetsBranch);
+  fSlimContentBranches.push_back(fJetPtBranch);
+  fSlimContentBranches.push_back(fJetPhiBranch);
+  fSlimContentBranches.push_back(fJetEtaBranch);
+  fSlimContentBranches.push_back(fJetRawPtBranch);
+  fSlimContentBranches.push_back(fJetMaxTrackPtBranch);
+  
+  // Tracks
+  fSlimForestTree->SetBranchAddress("nTracks",&fnTracks,&fnTracksBranch);
+  fSlimForestTree->SetBranchAddress("trackPt",fTrackPtArray,&fTrackPtBranch);
+  fSlimForestTree->SetBranchAddress("trackPtError",fTrackPtErrorArray,&fTrackPtErrorBranch);
+  fSlimForestTree->SetBranchAddress("trackPhi",fTrackPhiArray,&fTrackPhiBranch);
+  fSlimForestTree->SetBranchAddress("trackEta",fTrackEtaArray,&fTrackEtaBranch);
+  fSlimForestTree->SetBranchAddress("trackHighPurity",fHighPurityTrackArray,&fHighPurityTrackBranch);
+  fSlimForestTree->SetBranchAddress("trackVertexDistanceZ",fTrackVertexDistanceZArray,&fTrackVertexDistanceZBranch);
+  fSlimForestTree->SetBranchAddress("trackVertexDistanceZError",fTrackVertexDistanceZErrorArray,&fTrackVertexDistanceZErrorBranch);
+  fSlimForestTree->SetBranchAddress("trackVertexDistanceXY",fTrackVertexDistanceXYArray,&fTrackVertexDistanceXYBranch);
+  fSlimForestTree->SetBranchAddress("trackVertexDistanceXYError",fTrackVertexDistanceXYErrorArray,&fTrackVertexDistanceXYErrorBranch);
+  fSlimForestTree->SetBranchAddress("trackNormalizedChi2",fTrackNormalizedChi2Array,&fTrackChi2Branch);
+  fSlimForestTree->SetBranchAddress("trackHitsTrackerLayer",fnHitsTrackerLayerArray,&fnHitsTrackerLayerBranch);
+  fSlimForestTree->SetBranchAddress("trackHits",fnHitsTrackArray,&fnHitsTrackBranch);
+  fSlimForestTree->SetBranchAddress("trackEnergyEcal",fTrackEnergyEcalArray,&fTrackEnergyEcalBranch);
+  fSlimForestTree->SetBranchAddress("trackEnergyHcal",fTrackEnergyHcalArray,&fTrackEnergyHcalBranch);
+  
+  // Generator level jets and particles
+  if(fDataType == kPpMC || fDataType == kPbPbMC){
+    fSlimForestTree->SetBranchAddress("nGenJets",&fnGenJets,&fnGenJetsBranch);
+    fSlimForestTree->SetBranchAddress("genJetPt",fGenJetPtArray,&fGenJetPtBranch);
+    fSlimForestTree->SetBranchAddress("genJetPhi",fGenJetPhiArray,&fGenJetPhiBranch);
+    fSlimForestTree->SetBranchAddress("genJetEta",fGenJetEtaArray,&fGenJetEtaBranch);
+    fSlimForestTree->SetBranchAddress("genParticlePt",&fGenParticlePtArray,&fGenParticlePtBranch);
+    fSlimForestTree->SetBranchAddress("genParticlePhi",&fGenParticlePhiArray,&fGenParticlePhiBranch);
+    fSlimForestTree->SetBranchAddress("genParticleEta",&fGenParticleEtaArray,&fGenParticleEtaBranch);
+    fSlimForestTree->SetBranchAddress("genParticleCharge",&fGenParticleChargeArray,&fGenParticleChargeBranch);
+    fSlimForestTree->SetBranchAddress("genParticleSubevent",&fGenParticleSubeventArray,&fGenParticleSubeventBranch);
+    fSlimContentBranches.push_back(fnGenJetsBranch);
+    fSlimContentBranches.push_back(fGenJetPtBranch);
+    fSlimContentBranches.push_back(fGenJetPhiBranch);
+    fSlimContentBranches.push_back(fGenJetEtaBranch);
+    fSlimContentBranches.push_back(fGenParticlePtBranch);
+    fSlimContentBranches.push_back(fGenParticlePhiBranch);
+    fSlimContentBranches.push_back(fGenParticleEtaBranch);
+    fSlimContentBranches.push_back(fGenParticleChargeBranch);
+    fSlimContentBranches.push_back(fGenParticleSubeventBranch);
+  }
+  
+}
+
+/*
+ * Collect the track branches to a table such that they can be read one by one on demand
+ */
+void ForestReader::CollectTrackColumnBranches(){
+  fTrackColumnBranches[kTrackPtColumn] = fTrackPtBranch;
+  fTrackColumnBranches[kTrackPtErrorColumn] = fTrackPtErrorBranch;
+  fTrackColumnBranches[kTrackPhiColumn] = fTrackPhiBranch;
+  fTrackColumnBranches[kTrackEtaColumn] = fTrackEtaBranch;
+  fTrackColumnBranches[kHighPurityColumn] = fHighPurityTrackBranch;
+  fTrackColumnBranches[kVertexDistanceZColumn] = fTrackVertexDistanceZBranch;
+  fTrackColumnBranches[kVertexDistanceZErrorColumn] = fTrackVertexDistanceZErrorBranch;
+  fTrackColumnBranches[kVertexDistanceXYColumn] = fTrackVertexDistanceXYBranch;
+  fTrackColumnBranches[kVertexDistanceXYErrorColumn] = fTrackVertexDistanceXYErrorBranch;
+  fTrackColumnBranches[kChi2Column] = fTrackChi2Branch;
+  fTrackColumnBranches[kDegreesOfFreedomColumn] = (fIsMiniAOD || fIsSlimForest) ? 0 : fnTrackDegreesOfFreedomBranch; // Not in MiniAOD or slim forest
+  fTrackColumnBranches[kHitsTrackerLayerColumn] = fnHitsTrackerLayerBranch;
+  fTrackColumnBranches[kHitsTrackColumn] = fnHitsTrackBranch;
+  fTrackColumnBranches[kEnergyEcalColumn] = fTrackEnergyEcalBranch;
+  fTrackColumnBranches[kEnergyHcalColumn] = fTrackEnergyHcalBranch;
+  
+}
+
+/*
+ * Set up the read caches for all the trees in the forest. The total budget is divided between the trees
+ * according to the expected data volume read from them. This must be done after Initialize and
+ * CollectTrackColumnBranches, such that exactly the branches read by this reader are registered to the caches.
+ * Then all the baskets needed from one cluster are fetched in a single vectored read instead of one round trip per basket.
+ */
+void ForestReader::SetupTreeCaches(){
+  
+  // No caches are set up if the budget is not given
+  if(fTreeCacheSize <= 0) return;
+  
+  // Relative share of the cache budget for each tree. Tracks dominate the data volume. Slim forest has only one tree.
+  const Double_t cacheShare[knForestTrees] = {0.02, 0.02, 0.02, 0.14, 0.65, 0.15, 1.0};
+  
+  TTree *forestTrees[knForestTrees];
+  Bool_t treeInUse[knForestTrees];
+  GetForestTrees(forestTrees, treeInUse);
+  
+  // Normalize the shares to the trees actually read
+  Double_t totalShare = 0;
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    if(treeInUse[iTree]) totalShare += cacheShare[iTree];
+  }
+  
+  std::vector<TBranch*> readBranches;
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    if(!treeInUse[iTree]) continue;
+    GetReadBranches(iTree, readBranches);
+    SetupTreeCache(forestTrees[iTree], (Long64_t)(fTreeCacheSize * cacheShare[iTree] / totalShare), readBranches);
+  }
+}
+
+/*
+ * Set up the read cache for one tree
+ *
+ *  Arguments:
+ *   TTree *tree = Tree for which the cache is set up
+ *   const Long64_t cacheSize = Size of the cache in bytes
+ *   const std::vector<TBranch*> &branches = Branches read from the tree. Only the baskets of these are fetched to the cache.
+ */
+void ForestReader::SetupTreeCache(TTree *tree, const Long64_t cacheSize, const std::vector<TBranch*> &branches){
+  if(tree == NULL) return;
+  
+  tree->SetCacheSize(cacheSize);
+  
+  // Register only the branches that are read and skip the learning phase. The learning phase would miss
+  // the content branches if the first events are rejected by the event cuts.
+  for(TBranch *branch : branches){
+    tree->AddBranchToCache(branch, kTRUE);
+  }
+  tree->StopCacheLearningPhase();
+  
+  // Read all the baskets of a cluster at once, such that the prefetching can work cluster by cluster
+  if(fAsyncPrefetch) tree->SetClusterPrefetch(kTRUE);
+}
+
+/*
+ * List the branches read from one forest tree. The track branches are taken from the column table.
+ *
+ *  Arguments:
+ *   const Int_t iTree = Index of the tree in enumForestTrees
+ *   std::vector<TBranch*> &branches = Vector to which the branches are listed. Branches not connected for this data type are left out.
+ */
+void ForestReader::GetReadBranches(const Int_t iTree, std::vector<TBranch*> &branches) const{
+  
+  branches.clear();
+  
+  switch(iTree){
+    case kHeavyIonTree:
+      branches.push_back(fHiVzBranch);
+      branches.push_back(fHiBinBranch);
+      branches.push_back(fPtHatBranch);
+      branches.push_back(fEventWeightBranch);
+      break;
+    case kHltTree:
+      branches.push_back(fJetFilterBranch);
+      break;
+    case kSkimTree:
+      branches.push_back(fPrimaryVertexBranch);
+      branches.push_back(fBeamScrapingBranch);
+      branches.push_back(fHfCoincidenceBranch);
+      branches.push_back(fClusterCompatibilityBranch);
+      break;
+    case kJetTree:
+      branches.push_back(fnJetsBranch);
+      branches.push_back(fJetPtBranch);
+      branches.push_back(fJetPhiBranch);
+      branches.push_back(fJetEtaBranch);
+      branches.push_back(fJetRawPtBranch);
+      branches.push_back(fJetMaxTrackPtBranch);
+      branches.push_back(fnGenJetsBranch);
+      branches.push_back(fGenJetPtBranch);
+      branches.push_back(fGenJetPhiBranch);
+      branches.push_back(fGenJetEtaBranch);
+      break;
+    case kTrackTree:
+      branches.push_back(fnTracksBranch);
+      branches.insert(branches.end(), fTrackColumnBranches, fTrackColumnBranches + knTrackColumns);
+      break;
+    case kGenParticleTree:
+      branches.push_back(fGenParticlePtBranch);
+      branches.push_back(fGenParticlePhiBranch);
+      branches.push_back(fGenParticleEtaBranch);
+      branches.push_back(fGenParticleChargeBranch);
+      branches.push_back(fGenParticleSubeventBranch);
+      break;
+    case kSlimForestTree:
+      branches.insert(branches.end(), fSlimEventBranches.begin(), fSlimEventBranches.end());
+      branches.insert(branches.end(), fSlimContentBranches.begin(), fSlimContentBranches.end());
+      branches.push_back(fnTracksBranch);
+      branches.insert(branches.end(), fTrackColumnBranches, fTrackColumnBranches + knTrackColumns);
+      break;
+  }
+  
+  // Leave out the branches that are not connected
+  branches.erase(std::remove(branches.begin(), branches.end(), (TBranch*)NULL), branches.end());
+}
+
+/*
+ * List the trees of the connected forest
+ *
+ *  Arguments:
+ *   TTree *forestTrees[knForestTrees] = Array to which the trees are listed in the order of enumForestTrees
+ *   Bool_t treeInUse[knForestTrees] = Array to which the flags for trees read by this reader are listed
+ */
+void ForestReader::GetForestTrees(TTree *forestTrees[knForestTrees], Bool_t treeInUse[knForestTrees]) const{
+  
+  forestTrees[kHeavyIonTree] = fHeavyIonTree;
+  forestTrees[kHltTree] = fHltTree;
+  forestTrees[kSkimTree] = fSkimTree;
+  forestTrees[kJetTree] = fJetTree;
+  forestTrees[kTrackTree] = fTrackTree;
+  forestTrees[kGenParticleTree] = fGenParticleTree;
+  forestTrees[kSlimForestTree] = fSlimForestTree;
+  
+  // Slim forest has only one tree
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    treeInUse[iTree] = !fIsSlimForest;
+  }
+  treeInUse[kHltTree] = !fIsSlimForest && fUseTrigger;
+  treeInUse[kGenParticleTree] = !fIsSlimForest && (fDataType == kPpMC || fDataType == kPbPbMC);
+  treeInUse[kSlimForestTree] = fIsSlimForest;
+}
+
+/*
+ * Enable parallel decompression for the trees read by the reader and start collecting the decompression statistics.
+ * Must be called before the read caches are set up, since the type of the cache depends on the parallel unzipping.
+ */
+void ForestReader::SetupTreeDecompression(){
+  
+  TTree *forestTrees[knForestTrees];
+  Bool_t treeInUse[knForestTrees];
+  GetForestTrees(forestTrees, treeInUse);
+  
+  const Bool_t parallelUnzip = (fNumberOfThreads > 1);
+  
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    if(!treeInUse[iTree] || forestTrees[iTree] == NULL) continue;
+    
+    // Read the branches of an entry in parallel, and decompress the baskets in the read cache in parallel
+    forestTrees[iTree]->SetImplicitMT(parallelUnzip);
+    forestTrees[iTree]->SetParallelUnzip(parallelUnzip);
+    
+    // The statistics are collected separately for each tree
+    fTreePerfStats[iTree] = new TTreePerfStats(Form("readStatistics%d", iTree), forestTrees[iTree]);
+  }
+}
+
+/*
+ * Add the decompression times of the connected trees to the totals and stop collecting statistics for them.
+ * The statistics are detached from the trees before they are deleted, since the trees can be shared with another
+ * reader connected to the same file. The trees must still exist, so this is called before the file is closed.
+ */
+void ForestReader::CollectTreeUnzipTimes(){
+  TTree *forestTrees[knForestTrees];
+  Bool_t treeInUse[knForestTrees];
+  GetForestTrees(forestTrees, treeInUse);
+  
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    if(fTreePerfStats[iTree] == NULL) continue;
+    fTreeUnzipTime[iTree] += fTreePerfStats[iTree]->GetUnzipTime();
+    if(forestTrees[iTree] && forestTrees[iTree]->GetPerfStats() == fTreePerfStats[iTree]) forestTrees[iTree]->SetPerfStats(0);
+    delete fTreePerfStats[iTree];
+    fTreePerfStats[iTree] = 0;
+  }
+}
+
+/*
+ * Stop reading the current forest. Must be called before the forest file is closed, such that nothing is left
+ * attached to the trees deleted with the file.
+ */
+void ForestReader::DisconnectForest(){
+  CollectTreeUnzipTimes();
+}
+
 /*
  * Setter for fDataType
  */
@@ -746,11 +1206,81 @@ void ForestReader::SetDataType(Int_t dataType){
   }
 }
 
+/*
+ * Setter for reading track columns on demand
+ *
+ *  Arguments:
+ *   Bool_t onDemand: True: Each track column is read when a getter needs it for the first time in an event. False: Read all track columns for each event
+ */
+void ForestReader::SetReadTrackColumnsOnDemand(Bool_t onDemand){
+  fReadTrackColumnsOnDemand = onDemand;
+}
+
+/*
+ * Setter for the total read cache budget
+ *
+ *  Arguments:
+ *   Long64_t cacheSize: Total size of the TTreeCaches in bytes. The budget is divided between the trees based on their expected data volume. 0 = No caches are set up.
+ */
+void ForestReader::SetTreeCacheSize(Long64_t cacheSize){
+  fTreeCacheSize = cacheSize;
+}
+
+/*
+ * Setter for asynchronous prefetching
+ *
+ *  Arguments:
+ *   Bool_t asyncPrefetch: True: The read cache fetches the baskets of the next cluster while the current one is read. False: Fetch baskets when needed
+ */
+void ForestReader::SetAsyncPrefetching(Bool_t asyncPrefetch){
+  fAsyncPrefetch = asyncPrefetch;
+  
+  // The file read caches check this when they are created
+  if(fAsyncPrefetch) gEnv->SetValue("TFile.AsyncPrefetching", 1);
+}
+
+/*
+ * Setter for the number of threads used to decompress the baskets
+ *
+ *  Arguments:
+ *   Int_t nThreads: Size of the ROOT implicit multithreading pool. The branches and baskets of the trees are decompressed in parallel if more than one thread is given.
+ *
+ * Implicit multithreading only splits TTree::GetEntry over the branches. Track columns read on demand are read
+ * branch by branch with TBranch::GetEntry in the reading thread, so then only the baskets in the read caches are
+ * decompressed in parallel and most of the pool is idle. Compare the unzip times printed at the end of the run
+ * with one thread before giving more threads, and remember that the job memory needs to hold the thread stacks.
+ */
+void ForestReader::SetNumberOfThreads(Int_t nThreads){
+  fNumberOfThreads = nThreads;
+  
+  // The thread pool is shared by all the readers, so it is created only once
+  if(fNumberOfThreads > 1 && !ROOT::IsImplicitMTEnabled()) ROOT::EnableImplicitMT(fNumberOfThreads);
+}
+
 /*
  * Connect a new tree to the reader
  */
 void ForestReader::ReadForestFromFile(TFile *inputFile){
   
+  // The event data is read to the branch buffers of this reader
+  fIsMappedForest = false;
+  ResetEventView();
+  
+  // The trees of the previous forest are not read anymore
+  CollectTreeUnzipTimes();
+  
+  // Slim forests contain all the information in a single tree, which is connected directly
+  fSlimForestTree = (TTree*)inputFile->Get("slimForest");
+  fIsSlimForest = !(fSlimForestTree == NULL);
+  if(fIsSlimForest){
+    fIsMiniAOD = false;
+    InitializeSlimForest();
+    CollectTrackColumnBranches();
+    SetupTreeDecompression();
+    SetupTreeCaches();
+    return;
+  }
+  
   // When reading a forest, we need to check if it is AOD or MiniAOD forest as there are some differences
   // The HiForest tree is renamed to HiForestInfo in MiniAODs, so we can determine the forest type from this.
   TTree* miniAODcheck = (TTree*)inputFile->Get("HiForestInfo/HiForest");
@@ -790,6 +1320,25 @@ void ForestReader::ReadForestFromFile(TFile *inputFile){
   }
   
   Initialize();
+  CollectTrackColumnBranches();
+  SetupTreeDecompression();
+  SetupTreeCaches();
+}
+
+/*
+ * Map a forest file written by slimForestConverter in the mapped format. The getters read the data directly from the mapped pages.
+ *
+ *  Arguments:
+ *   const char *fileName = Name of the mapped forest file
+ */
+void ForestReader::ReadMappedForestFromFile(const char *fileName){
+  
+  if(fMappedForest == NULL) fMappedForest = new MappedForestFile();
+  fMappedForest->Open(fileName);
+  
+  fIsMappedForest = true;
+  fIsMiniAOD = false;
+  fIsSlimForest = false;
 }
 
 /*
@@ -804,6 +1353,19 @@ void ForestReader::ReadForestFromFileList(std::vector<TString> fileList){
  * Burn the current forest.
  */
 void ForestReader::BurnForest(){
+  
+  // Mapped forest only needs to be unmapped
+  if(fIsMappedForest){
+    fMappedForest->Close();
+    return;
+  }
+  
+  // Slim forest has only one tree
+  if(fIsSlimForest){
+    fSlimForestTree->Delete();
+    return;
+  }
+  
   fHeavyIonTree->Delete();
   if(fUseTrigger) fHltTree->Delete();
   fSkimTree->Delete();
@@ -816,21 +1378,517 @@ void ForestReader::BurnForest(){
  * Load an event to memory
  */
 void ForestReader::GetEvent(Int_t nEvent){
+  GetEventInformation(nEvent);
+  GetEventContent();
+}
+
+/*
+ * Load only the event level information to memory. This includes vz, hiBin, pT hat, event weight
+ * and the filter bits, which are everything needed to decide if the event is accepted for the analysis.
+ * The large jet, track and particle trees are not touched here, so rejected events never need to read them.
+ */
+void ForestReader::GetEventInformation(Int_t nEvent){
+  fCurrentEvent = nEvent;
+  
+  // For mapped forest, find the event from the mapped file and take the event information from the event header
+  if(fIsMappedForest){
+    fMappedForest->ReadEvent(nEvent);
+    const MappedForestFile::EventHeader *eventHeader = fMappedForest->GetEventHeader();
+    fVertexZ = eventHeader->fVertexZ;
+    fHiBin = eventHeader->fHiBin;
+    fPtHat = eventHeader->fPtHat;
+    fEventWeight = eventHeader->fEventWeight;
+    fJetFilterBit = eventHeader->fJetFilterBit;
+    fPrimaryVertexFilterBit = eventHeader->fPrimaryVertexFilterBit;
+    fBeamScrapingFilterBit = eventHeader->fBeamScrapingFilterBit;
+    fHfCoincidenceFilterBit = eventHeader->fHfCoincidenceFilterBit;
+    fClusterCompatibilityFilterBit = eventHeader->fClusterCompatibilityFilterBit;
+    return;
+  }
+  
+  // In slim forest, the event level information is read branch by branch from the single tree
+  if(fIsSlimForest){
+    for(TBranch *eventBranch : fSlimEventBranches) eventBranch->GetEntry(nEvent);
+    return;
+  }
+  
   fHeavyIonTree->GetEntry(nEvent);
-  fJetTree->GetEntry(nEvent);
   if(fUseTrigger) fHltTree->GetEntry(nEvent);
   fSkimTree->GetEntry(nEvent);
-  fTrackTree->GetEntry(nEvent);
+}
+
+/*
+ * Load the jets, tracks and generator level particles for the event read with GetEventInformation.
+ * This should only be called for events that pass the event selection.
+ */
+void ForestReader::GetEventContent(){
+  
+  // For mapped forest, point the event data directly to the mapped columns. Nothing is copied.
+  if(fIsMappedForest){
+    const MappedForestFile::EventHeader *eventHeader = fMappedForest->GetEventHeader();
+    fnJets = eventHeader->fnObjects[MappedForestFile::kJets];
+    fnGenJets = eventHeader->fnObjects[MappedForestFile::kGenJets];
+    fnTracks = eventHeader->fnObjects[MappedForestFile::kTracks];
+    fnGenParticles = eventHeader->fnObjects[MappedForestFile::kGenParticles];
+    fEventView.fnJets = fnJets;
+    fEventView.fnGenJets = fnGenJets;
+    fEventView.fnTracks = fnTracks;
+    fEventView.fnGenParticles = fnGenParticles;
+    
+    fEventView.fJetPt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kJetPt);
+    fEventView.fJetPhi = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kJetPhi);
+    fEventView.fJetEta = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kJetEta);
+    fEventView.fJetRawPt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kJetRawPt);
+    fEventView.fJetMaxTrackPt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kJetMaxTrackPt);
+    
+    fEventView.fGenJetPt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenJetPt);
+    fEventView.fGenJetPhi = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenJetPhi);
+    fEventView.fGenJetEta = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenJetEta);
+    
+    fEventView.fTrackPt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackPt);
+    fEventView.fTrackPtError = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackPtError);
+    fEventView.fTrackPhi = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackPhi);
+    fEventView.fTrackEta = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackEta);
+    fEventView.fTrackHighPurity = (const Bool_t*) fMappedForest->GetColumn(MappedForestFile::kTrackHighPurity);
+    fEventView.fTrackVertexDistanceZ = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackVertexDistanceZ);
+    fEventView.fTrackVertexDistanceZError = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackVertexDistanceZError);
+    fEventView.fTrackVertexDistanceXY = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackVertexDistanceXY);
+    fEventView.fTrackVertexDistanceXYError = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackVertexDistanceXYError);
+    fEventView.fTrackNormalizedChi2 = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackNormalizedChi2);
+    fEventView.fTrackHitsTrackerLayer = (const UChar_t*) fMappedForest->GetColumn(MappedForestFile::kTrackHitsTrackerLayer);
+    fEventView.fTrackHits = (const UChar_t*) fMappedForest->GetColumn(MappedForestFile::kTrackHits);
+    fEventView.fTrackEnergyEcal = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackEnergyEcal);
+    fEventView.fTrackEnergyHcal = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kTrackEnergyHcal);
+    
+    fEventView.fGenParticlePt = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenParticlePt);
+    fEventView.fGenParticlePhi = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenParticlePhi);
+    fEventView.fGenParticleEta = (const Float_t*) fMappedForest->GetColumn(MappedForestFile::kGenParticleEta);
+    fEventView.fGenParticleCharge = (const Int_t*) fMappedForest->GetColumn(MappedForestFile::kGenParticleCharge);
+    fEventView.fGenParticleSubevent = (const Int_t*) fMappedForest->GetColumn(MappedForestFile::kGenParticleSubevent);
+    
+    fnTrackEventsRead++;
+    for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+      fTrackColumnLoaded[iColumn] = true;
+    }
+    return;
+  }
+  
+  // Read the numbers of jets and tracks first, such that the buffers can be made large enough for the arrays
+  fnJetsBranch->GetEntry(fCurrentEvent);
+  if(fnGenJetsBranch) fnGenJetsBranch->GetEntry(fCurrentEvent);
+  if(ReserveJetBuffers(std::max(fnJets, fnGenJets))) ConnectJetBuffers();
+  fnTracksBranch->GetEntry(fCurrentEvent);
+  if(ReserveTrackBuffers(fnTracks)) ConnectTrackBuffers();
+  
+  // In slim forest, jets and generator level information are read branch by branch from the single tree
+  if(fIsSlimForest){
+    for(TBranch *contentBranch : fSlimContentBranches) contentBranch->GetEntry(fCurrentEvent);
+  } else {
+    fJetTree->GetEntry(fCurrentEvent);
+  }
+  fnTrackEventsRead++;
+  
+  // When reading track columns on demand, only the number of tracks is read here. Other columns are read by the getters.
+  if(fReadTrackColumnsOnDemand){
+    for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+      fTrackColumnLoaded[iColumn] = false;
+    }
+  } else if(fIsSlimForest){
+    for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+      if(fTrackColumnBranches[iColumn]) fTrackColumnBranches[iColumn]->GetEntry(fCurrentEvent);
+      fTrackColumnLoaded[iColumn] = true;
+    }
+  } else {
+    fTrackTree->GetEntry(fCurrentEvent);
+    for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+      fTrackColumnLoaded[iColumn] = true;
+    }
+  }
+  
   if(fDataType == kPpMC || fDataType == kPbPbMC) {
-    fGenParticleTree->GetEntry(nEvent);
+    if(!fIsSlimForest) fGenParticleTree->GetEntry(fCurrentEvent);
    
     // Read the numbers of generator level particles for this event
     fnGenParticles = fGenParticlePtArray->size();
   }
+  
+  UpdateEventView();
+}
+
+/*
+ * Point the event view to the branch buffers of this reader. For AOD and slim forests the buffers do not move,
+ * so this is valid for the whole file. For MiniAOD forests the track columns point to the vectors, which need
+ * to be updated after each read.
+ */
+void ForestReader::ResetEventView(){
+  
+  fEventView.fnJets = 0;
+  fEventView.fnGenJets = 0;
+  fEventView.fnTracks = 0;
+  fEventView.fnGenParticles = 0;
+  
+  fEventView.fJetPt = fJetPtArray;
+  fEventView.fJetPhi = fJetPhiArray;
+  fEventView.fJetEta = fJetEtaArray;
+  fEventView.fJetRawPt = fJetRawPtArray;
+  fEventView.fJetMaxTrackPt = fJetMaxTrackPtArray;
+  
+  fEventView.fGenJetPt = fGenJetPtArray;
+  fEventView.fGenJetPhi = fGenJetPhiArray;
+  fEventView.fGenJetEta = fGenJetEtaArray;
+  
+  fEventView.fTrackPt = fTrackPtArray;
+  fEventView.fTrackPtError = fTrackPtErrorArray;
+  fEventView.fTrackPhi = fTrackPhiArray;
+  fEventView.fTrackEta = fTrackEtaArray;
+  fEventView.fTrackHighPurity = fHighPurityTrackArray;
+  fEventView.fTrackVertexDistanceZ = fTrackVertexDistanceZArray;
+  fEventView.fTrackVertexDistanceZError = fTrackVertexDistanceZErrorArray;
+  fEventView.fTrackVertexDistanceXY = fTrackVertexDistanceXYArray;
+  fEventView.fTrackVertexDistanceXYError = fTrackVertexDistanceXYErrorArray;
+  fEventView.fTrackNormalizedChi2 = fTrackNormalizedChi2Array;
+  fEventView.fTrackHitsTrackerLayer = fnHitsTrackerLayerArray;
+  fEventView.fTrackHits = fnHitsTrackArray;
+  fEventView.fTrackEnergyEcal = fTrackEnergyEcalArray;
+  fEventView.fTrackEnergyHcal = fTrackEnergyHcalArray;
+  
+  // Generator level particles are in vectors, which are updated for each event
+  fEventView.fGenParticlePt = 0;
+  fEventView.fGenParticlePhi = 0;
+  fEventView.fGenParticleEta = 0;
+  fEventView.fGenParticleCharge = 0;
+  fEventView.fGenParticleSubevent = 0;
+}
+
+/*
+ * Update the event view after the event content has been read. The track columns that are not yet
+ * read are updated when they are loaded.
+ */
+void ForestReader::UpdateEventView(){
+  
+  fEventView.fnJets = fnJets;
+  fEventView.fnTracks = fnTracks;
+  fNormalizedChi2Ready = false;
+  
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    if(fTrackColumnLoaded[iColumn]) UpdateTrackColumnView(iColumn);
+  }
+  
+  // Generator level jets and particles
+  if(fDataType == kPpMC || fDataType == kPbPbMC){
+    fEventView.fnGenJets = fnGenJets;
+    fEventView.fnGenParticles = fnGenParticles;
+    fEventView.fGenParticlePt = fGenParticlePtArray->data();
+    fEventView.fGenParticlePhi = fGenParticlePhiArray->data();
+    fEventView.fGenParticleEta = fGenParticleEtaArray->data();
+    fEventView.fGenParticleCharge = fGenParticleChargeArray->data();
+    fEventView.fGenParticleSubevent = fGenParticleSubeventArray->data();
+  }
+}
+
+/*
+ * Update one track column in the event view after it has been read. MiniAOD vectors can move in memory
+ * between events, so the pointers are updated here. The high purity flags stored as vector<bool> are
+ * unpacked to an array and the AOD chi2 is normalized, such that all forests provide the same columns.
+ *
+ *  Arguments:
+ *   const Int_t iColumn = Index of the column in enumTrackColumns
+ */
+void ForestReader::UpdateTrackColumnView(const Int_t iColumn) const{
+  
+  // AOD forest gives chi2 and the number of degrees of freedom. Normalize when both are read.
+  if(!fIsMiniAOD){
+    if(fIsSlimForest || fIsMappedForest || fNormalizedChi2Ready) return;
+    if(iColumn != kChi2Column && iColumn != kDegreesOfFreedomColumn) return;
+    if(!fTrackColumnLoaded[kChi2Column] || !fTrackColumnLoaded[kDegreesOfFreedomColumn]) return;
+    for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+      fTrackNormalizedChi2Array[iTrack] = fTrackChi2Array[iTrack] / (1.0*fnTrackDegreesOfFreedomArray[iTrack]);
+    }
+    fNormalizedChi2Ready = true;
+    return;
+  }
+  
+  switch(iColumn){
+    case kTrackPtColumn: fEventView.fTrackPt = fTrackPtVector->data(); break;
+    case kTrackPtErrorColumn: fEventView.fTrackPtError = fTrackPtErrorVector->data(); break;
+    case kTrackPhiColumn: fEventView.fTrackPhi = fTrackPhiVector->data(); break;
+    case kTrackEtaColumn: fEventView.fTrackEta = fTrackEtaVector->data(); break;
+    case kHighPurityColumn:
+      for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+        fHighPurityTrackArray[iTrack] = (*fHighPurityTrackVector)[iTrack];
+      }
+      fEventView.fTrackHighPurity = fHighPurityTrackArray;
+      break;
+    case kVertexDistanceZColumn: fEventView.fTrackVertexDistanceZ = fTrackVertexDistanceZVector->data(); break;
+    case kVertexDistanceZErrorColumn: fEventView.fTrackVertexDistanceZError = fTrackVertexDistanceZErrorVector->data(); break;
+    case kVertexDistanceXYColumn: fEventView.fTrackVertexDistanceXY = fTrackVertexDistanceXYVector->data(); break;
+    case kVertexDistanceXYErrorColumn: fEventView.fTrackVertexDistanceXYError = fTrackVertexDistanceXYErrorVector->data(); break;
+    case kChi2Column: fEventView.fTrackNormalizedChi2 = fTrackNormalizedChi2Vector->data(); break;
+    case kHitsTrackerLayerColumn: fEventView.fTrackHitsTrackerLayer = (const UChar_t*) fnHitsTrackerLayerVector->data(); break;
+    case kHitsTrackColumn: fEventView.fTrackHits = (const UChar_t*) fnHitsTrackVector->data(); break;
+    case kEnergyEcalColumn: fEventView.fTrackEnergyEcal = fTrackEnergyEcalVector->data(); break;
+    case kEnergyHcalColumn: fEventView.fTrackEnergyHcal = fTrackEnergyHcalVector->data(); break;
+    default: break; // Number of degrees of freedom is not in MiniAOD forest
+  }
+}
+
+/*
+ * Getter for the struct-of-arrays view of the current event. When reading track columns on demand, only the
+ * requested track columns are read here. The view can be asked again with more columns for the same event.
+ *
+ *  Arguments:
+ *   Int_t trackColumns = Bitmask of the track columns in enumTrackColumns used from the view
+ *
+ *   return: View to the current event
+ */
+const ForestReader::EventView& ForestReader::GetEventView(Int_t trackColumns) const{
+  if(fReadTrackColumnsOnDemand){
+    
+    // The normalized chi2 in AOD forest needs also the number of degrees of freedom
+    if(trackColumns & (1 << kChi2Column)) trackColumns |= (1 << kDegreesOfFreedomColumn);
+    
+    for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+      if(trackColumns & (1 << iColumn)) RequireTrackColumn(iColumn);
+    }
+  }
+  return fEventView;
+}
+
+/*
+ * Make sure that the jet buffers can hold the given number of jets. The buffers only grow, such that after
+ * the largest event has been seen they are reused for all the following events.
+ *
+ *  Arguments:
+ *   const Int_t nJets = Number of jets in the event that is read next
+ *
+ *   return: True if the buffers were reallocated, false otherwise
+ */
+Bool_t ForestReader::ReserveJetBuffers(const Int_t nJets){
+  if(nJets <= fJetBufferSize) return false;
+  
+  if(nJets > fnMaxJet){
+    cout << "ForestReader: Event " << fCurrentEvent << " has " << nJets << " jets, more than the old limit of " << fnMaxJet << ". Growing the jet buffers." << endl;
+  }
+  
+  AllocateJetBuffers(((nJets + fBufferGranularity - 1) / fBufferGranularity) * fBufferGranularity);
+  return true;
+}
+
+/*
+ * Make sure that the track buffers can hold the given number of tracks. The buffers only grow, such that after
+ * the largest event has been seen they are reused for all the following events.
+ *
+ *  Arguments:
+ *   const Int_t nTracks = Number of tracks in the event that is read next
+ *
+ *   return: True if the buffers were reallocated, false otherwise
+ */
+Bool_t ForestReader::ReserveTrackBuffers(const Int_t nTracks){
+  if(nTracks <= fTrackBufferSize) return false;
+  
+  if(nTracks > fnMaxTrack){
+    cout << "ForestReader: Event " << fCurrentEvent << " has " << nTracks << " tracks, more than the old limit of " << fnMaxTrack << ". Growing the track buffers." << endl;
+  }
+  
+  AllocateTrackBuffers(((nTracks + fBufferGranularity - 1) / fBufferGranularity) * fBufferGranularity);
+  return true;
+}
+
+/*
+ * Replace one buffer with a new buffer of the given size. The old content is not kept.
+ *
+ *  Arguments:
+ *   T *&buffer = Buffer to be replaced
+ *   const Int_t bufferSize = Number of elements in the new buffer. Zero only deletes the old buffer.
+ *   const T initialValue = Value to which all the elements of the new buffer are set
+ */
+template <typename T> static void ReallocateBuffer(T *&buffer, const Int_t bufferSize, const T initialValue){
+  delete[] buffer;
+  buffer = 0;
+  if(bufferSize <= 0) return;
+  buffer = new T[bufferSize];
+  std::fill(buffer, buffer + bufferSize, initialValue);
+}
+
+/*
+ * Replace the jet buffers with buffers of the given size. The event view is pointed to the new buffers,
+ * but the branches need to be connected separately with ConnectJetBuffers.
+ *
+ *  Arguments:
+ *   const Int_t bufferSize = Number of jets that fit to the new buffers
+ */
+void ForestReader::AllocateJetBuffers(const Int_t bufferSize){
+  ReallocateBuffer(fJetPtArray, bufferSize, 0.f);
+  ReallocateBuffer(fJetPhiArray, bufferSize, 0.f);
+  ReallocateBuffer(fJetEtaArray, bufferSize, 0.f);
+  ReallocateBuffer(fJetRawPtArray, bufferSize, 0.f);
+  ReallocateBuffer(fJetMaxTrackPtArray, bufferSize, -1.f);
+  ReallocateBuffer(fGenJetPtArray, bufferSize, 0.f);
+  ReallocateBuffer(fGenJetPhiArray, bufferSize, 0.f);
+  ReallocateBuffer(fGenJetEtaArray, bufferSize, 0.f);
+  fJetBufferSize = bufferSize;
+  
+  fEventView.fJetPt = fJetPtArray;
+  fEventView.fJetPhi = fJetPhiArray;
+  fEventView.fJetEta = fJetEtaArray;
+  fEventView.fJetRawPt = fJetRawPtArray;
+  fEventView.fJetMaxTrackPt = fJetMaxTrackPtArray;
+  fEventView.fGenJetPt = fGenJetPtArray;
+  fEventView.fGenJetPhi = fGenJetPhiArray;
+  fEventView.fGenJetEta = fGenJetEtaArray;
+}
+
+/*
+ * Replace the track buffers with buffers of the given size. The event view is pointed to the new buffers,
+ * but the branches need to be connected separately with ConnectTrackBuffers.
+ *
+ *  Arguments:
+ *   const Int_t bufferSize = Number of tracks that fit to the new buffers
+ */
+void ForestReader::AllocateTrackBuffers(const Int_t bufferSize){
+  ReallocateBuffer(fTrackPtArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackPtErrorArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackPhiArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackEtaArray, bufferSize, 0.f);
+  ReallocateBuffer(fHighPurityTrackArray, bufferSize, (Bool_t)false);
+  ReallocateBuffer(fTrackVertexDistanceZArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackVertexDistanceZErrorArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackVertexDistanceXYArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackVertexDistanceXYErrorArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackChi2Array, bufferSize, 0.f);
+  ReallocateBuffer(fTrackNormalizedChi2Array, bufferSize, 0.f);
+  ReallocateBuffer(fnTrackDegreesOfFreedomArray, bufferSize, (UChar_t)0);
+  ReallocateBuffer(fnHitsTrackerLayerArray, bufferSize, (UChar_t)0);
+  ReallocateBuffer(fnHitsTrackArray, bufferSize, (UChar_t)0);
+  ReallocateBuffer(fTrackEnergyEcalArray, bufferSize, 0.f);
+  ReallocateBuffer(fTrackEnergyHcalArray, bufferSize, 0.f);
+  fTrackBufferSize = bufferSize;
+  
+  // For MiniAOD forests only the high purity flags are read through these buffers. The columns read
+  // before the reallocation are pointed to the new buffers when they are updated for the event.
+  if(fIsMiniAOD){
+    fEventView.fTrackHighPurity = fHighPurityTrackArray;
+    return;
+  }
+  
+  fEventView.fTrackPt = fTrackPtArray;
+  fEventView.fTrackPtError = fTrackPtErrorArray;
+  fEventView.fTrackPhi = fTrackPhiArray;
+  fEventView.fTrackEta = fTrackEtaArray;
+  fEventView.fTrackHighPurity = fHighPurityTrackArray;
+  fEventView.fTrackVertexDistanceZ = fTrackVertexDistanceZArray;
+  fEventView.fTrackVertexDistanceZError = fTrackVertexDistanceZErrorArray;
+  fEventView.fTrackVertexDistanceXY = fTrackVertexDistanceXYArray;
+  fEventView.fTrackVertexDistanceXYError = fTrackVertexDistanceXYErrorArray;
+  fEventView.fTrackNormalizedChi2 = fTrackNormalizedChi2Array;
+  fEventView.fTrackHitsTrackerLayer = fnHitsTrackerLayerArray;
+  fEventView.fTrackHits = fnHitsTrackArray;
+  fEventView.fTrackEnergyEcal = fTrackEnergyEcalArray;
+  fEventView.fTrackEnergyHcal = fTrackEnergyHcalArray;
+}
+
+/*
+ * Point the jet branches to the current jet buffers
+ */
+void ForestReader::ConnectJetBuffers(){
+  if(fJetPtBranch) fJetPtBranch->SetAddress(fJetPtArray);
+  if(fJetPhiBranch) fJetPhiBranch->SetAddress(fJetPhiArray);
+  if(fJetEtaBranch) fJetEtaBranch->SetAddress(fJetEtaArray);
+  if(fJetRawPtBranch) fJetRawPtBranch->SetAddress(fJetRawPtArray);
+  if(fJetMaxTrackPtBranch) fJetMaxTrackPtBranch->SetAddress(fJetMaxTrackPtArray);
+  if(fGenJetPtBranch) fGenJetPtBranch->SetAddress(fGenJetPtArray);
+  if(fGenJetPhiBranch) fGenJetPhiBranch->SetAddress(fGenJetPhiArray);
+  if(fGenJetEtaBranch) fGenJetEtaBranch->SetAddress(fGenJetEtaArray);
+}
+
+/*
+ * Point the track branches to the current track buffers. MiniAOD forests read the tracks to vectors instead.
+ */
+void ForestReader::ConnectTrackBuffers(){
+  if(fIsMiniAOD) return;
+  
+  fTrackPtBranch->SetAddress(fTrackPtArray);
+  fTrackPtErrorBranch->SetAddress(fTrackPtErrorArray);
+  fTrackPhiBranch->SetAddress(fTrackPhiArray);
+  fTrackEtaBranch->SetAddress(fTrackEtaArray);
+  fHighPurityTrackBranch->SetAddress(fHighPurityTrackArray);
+  fTrackVertexDistanceZBranch->SetAddress(fTrackVertexDistanceZArray);
+  fTrackVertexDistanceZErrorBranch->SetAddress(fTrackVertexDistanceZErrorArray);
+  fTrackVertexDistanceXYBranch->SetAddress(fTrackVertexDistanceXYArray);
+  fTrackVertexDistanceXYErrorBranch->SetAddress(fTrackVertexDistanceXYErrorArray);
+  fnHitsTrackerLayerBranch->SetAddress(fnHitsTrackerLayerArray);
+  fnHitsTrackBranch->SetAddress(fnHitsTrackArray);
+  fTrackEnergyEcalBranch->SetAddress(fTrackEnergyEcalArray);
+  fTrackEnergyHcalBranch->SetAddress(fTrackEnergyHcalArray);
+  
+  // Slim forest stores the normalized chi2, AOD forest the chi2 and the number of degrees of freedom
+  if(fIsSlimForest){
+    fTrackChi2Branch->SetAddress(fTrackNormalizedChi2Array);
+  } else {
+    fTrackChi2Branch->SetAddress(fTrackChi2Array);
+    fnTrackDegreesOfFreedomBranch->SetAddress(fnTrackDegreesOfFreedomArray);
+  }
+}
+
+/*
+ * Read the entry of the current event from one track column
+ *
+ *  Arguments:
+ *   const Int_t iColumn = Index of the column in enumTrackColumns
+ */
+void ForestReader::LoadTrackColumn(const Int_t iColumn) const{
+  fTrackColumnLoaded[iColumn] = true;
+  if(fTrackColumnBranches[iColumn] == NULL) return; // Column does not exist in this forest
+  fTrackColumnBytesRead[iColumn] += fTrackColumnBranches[iColumn]->GetEntry(fCurrentEvent);
+  fTrackColumnEntriesRead[iColumn]++;
+  UpdateTrackColumnView(iColumn);
+}
+
+/*
+ * Print the number of bytes read from each track column. Only meaningful when reading columns on demand.
+ */
+void ForestReader::PrintTrackColumnReadStatistics() const{
+  
+  const char* columnNames[knTrackColumns] = {"pT", "pT error", "phi", "eta", "high purity", "dz", "dz error", "dxy", "dxy error", "chi2", "nDof", "nLayers", "nHits", "ECal energy", "HCal energy"};
+  
+  if(!fReadTrackColumnsOnDemand){
+    cout << "Track columns are not read on demand. All columns are read for " << fnTrackEventsRead << " events." << endl;
+    return;
+  }
+  
+  Long64_t totalBytes = 0;
+  cout << "Track columns read on demand for " << fnTrackEventsRead << " events:" << endl;
+  for(Int_t iColumn = 0; iColumn < knTrackColumns; iColumn++){
+    if(fTrackColumnBranches[iColumn] == NULL) continue;
+    cout << Form("  %12s: read in %10lld events (%5.1f %%), %14lld bytes", columnNames[iColumn], fTrackColumnEntriesRead[iColumn], fnTrackEventsRead > 0 ? 100.0*fTrackColumnEntriesRead[iColumn]/fnTrackEventsRead : 0.0, fTrackColumnBytesRead[iColumn]) << endl;
+    totalBytes += fTrackColumnBytesRead[iColumn];
+  }
+  cout << "  Total bytes read from track columns: " << totalBytes << endl;
+}
+
+/*
+ * Print the time spent decompressing the baskets of each forest tree in all the files read so far
+ */
+void ForestReader::PrintTreeUnzipTimes(){
+  
+  const char* treeNames[knForestTrees] = {"heavy ion", "HLT", "skim", "jet", "track", "gen particle", "slim forest"};
+  
+  Double_t totalUnzipTime = 0;
+  Double_t unzipTime;
+  cout << "Basket decompression time with " << fNumberOfThreads << (fNumberOfThreads > 1 ? " threads" : " thread") << ":" << endl;
+  for(Int_t iTree = 0; iTree < knForestTrees; iTree++){
+    unzipTime = fTreeUnzipTime[iTree];
+    if(fTreePerfStats[iTree]) unzipTime += fTreePerfStats[iTree]->GetUnzipTime();
+    if(unzipTime <= 0) continue;
+    cout << Form("  %12s tree: %10.2f s", treeNames[iTree], unzipTime) << endl;
+    totalUnzipTime += unzipTime;
+  }
+  cout << Form("  Total decompression time: %10.2f s", totalUnzipTime) << endl;
 }
 
 // Getter for number of events in the tree
 Int_t ForestReader::GetNEvents() const{
+  if(fIsMappedForest) return fMappedForest->GetNEvents();
   return fJetPtBranch->GetEntries();
 }
 
@@ -846,42 +1904,42 @@ Int_t ForestReader::GetNGeneratorJets() const{
 
 // Getter for jet pT
 Float_t ForestReader::GetJetPt(Int_t iJet) const{
-  return fJetPtArray[iJet];
+  return fEventView.fJetPt[iJet];
 }
 
 // Getter for jet phi
 Float_t ForestReader::GetJetPhi(Int_t iJet) const{
-  return fJetPhiArray[iJet];
+  return fEventView.fJetPhi[iJet];
 }
 
 // Getter for jet eta
 Float_t ForestReader::GetJetEta(Int_t iJet) const{
-  return fJetEtaArray[iJet];
+  return fEventView.fJetEta[iJet];
 }
 
 // Getter for jet raw pT
 Float_t ForestReader::GetJetRawPt(Int_t iJet) const{
-  return fJetRawPtArray[iJet];
+  return fEventView.fJetRawPt[iJet];
 }
 
 // Getter for maximum track pT inside a jet
 Float_t ForestReader::GetJetMaxTrackPt(Int_t iJet) const{
-  return fJetMaxTrackPtArray[iJet];
+  return fEventView.fJetMaxTrackPt[iJet];
 }
 
 // Getter for generator level jet pT
 Float_t ForestReader::GetGeneratorJetPt(Int_t iJet) const{
-  return fGenJetPtArray[iJet];
+  return fEventView.fGenJetPt[iJet];
 }
 
 // Getter for generator level jet phi
 Float_t ForestReader::GetGeneratorJetPhi(Int_t iJet) const{
-  return fGenJetPhiArray[iJet];
+  return fEventView.fGenJetPhi[iJet];
 }
 
 // Getter for generator level jet eta
 Float_t ForestReader::GetGeneratorJetEta(Int_t iJet) const{
-  return fGenJetEtaArray[iJet];
+  return fEventView.fGenJetEta[iJet];
 }
 
 // Getter for vertex z position
@@ -942,98 +2000,104 @@ Int_t ForestReader::GetNTracks() const{
 
 // Getter for track pT
 Float_t ForestReader::GetTrackPt(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackPtVector->at(iTrack);
-  return fTrackPtArray[iTrack];
+  RequireTrackColumn(kTrackPtColumn);
+  return fEventView.fTrackPt[iTrack];
 }
 
 // Getter for track pT error
 Float_t ForestReader::GetTrackPtError(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackPtErrorVector->at(iTrack);
-  return fTrackPtErrorArray[iTrack];
+  RequireTrackColumn(kTrackPtErrorColumn);
+  return fEventView.fTrackPtError[iTrack];
 }
 
 // Getter for track phi
 Float_t ForestReader::GetTrackPhi(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackPhiVector->at(iTrack);
-  return fTrackPhiArray[iTrack];
+  RequireTrackColumn(kTrackPhiColumn);
+  return fEventView.fTrackPhi[iTrack];
 }
 
 // Getter for track eta
 Float_t ForestReader::GetTrackEta(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackEtaVector->at(iTrack);
-  return fTrackEtaArray[iTrack];
+  RequireTrackColumn(kTrackEtaColumn);
+  return fEventView.fTrackEta[iTrack];
 }
 
 // Getter for high purity of the track
 Bool_t ForestReader::GetTrackHighPurity(Int_t iTrack) const{
-  if(fIsMiniAOD) return fHighPurityTrackVector->at(iTrack);
-  return fHighPurityTrackArray[iTrack];
+  RequireTrackColumn(kHighPurityColumn);
+  return fEventView.fTrackHighPurity[iTrack];
 }
 
 // Getter for track distance from primary vertex in z-direction
 Float_t ForestReader::GetTrackVertexDistanceZ(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackVertexDistanceZVector->at(iTrack);
-  return fTrackVertexDistanceZArray[iTrack];
+  RequireTrackColumn(kVertexDistanceZColumn);
+  return fEventView.fTrackVertexDistanceZ[iTrack];
 }
 
 // Getter for error of track distance from primary vertex in z-direction
 Float_t ForestReader::GetTrackVertexDistanceZError(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackVertexDistanceZErrorVector->at(iTrack);
-  return fTrackVertexDistanceZErrorArray[iTrack];
+  RequireTrackColumn(kVertexDistanceZErrorColumn);
+  return fEventView.fTrackVertexDistanceZError[iTrack];
 }
 
 // Getter for track distance from primary vertex in xy-direction
 Float_t ForestReader::GetTrackVertexDistanceXY(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackVertexDistanceXYVector->at(iTrack);
-  return fTrackVertexDistanceXYArray[iTrack];
+  RequireTrackColumn(kVertexDistanceXYColumn);
+  return fEventView.fTrackVertexDistanceXY[iTrack];
 }
 
 // Getter for error of track distance from primary vertex in xy-direction
 Float_t ForestReader::GetTrackVertexDistanceXYError(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackVertexDistanceXYErrorVector->at(iTrack);
-  return fTrackVertexDistanceXYErrorArray[iTrack];
+  RequireTrackColumn(kVertexDistanceXYErrorColumn);
+  return fEventView.fTrackVertexDistanceXYError[iTrack];
 }
 
 // Getter for normalized track chi2 value from reconstruction fit
 Float_t ForestReader::GetTrackNormalizedChi2(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackNormalizedChi2Vector->at(iTrack);
+  if(fIsMiniAOD) RequireTrackColumn(kChi2Column);
+  if(fIsSlimForest || fIsMappedForest){
+    RequireTrackColumn(kChi2Column);
+    return fEventView.fTrackNormalizedChi2[iTrack];
+  }
   return GetTrackChi2(iTrack) / (1.0*GetNTrackDegreesOfFreedom(iTrack));
 }
 
 // Getter for track chi2 value from reconstruction fit
 Float_t ForestReader::GetTrackChi2(Int_t iTrack) const{
-  if(fIsMiniAOD) return -1; // Does not exist in MiniAOD forest
+  if(fIsMiniAOD || fIsSlimForest || fIsMappedForest) return -1; // Does not exist in MiniAOD, slim or mapped forest
+  RequireTrackColumn(kChi2Column);
   return fTrackChi2Array[iTrack];
 }
 
 // Getter for number of degrees of freedom in reconstruction fit
 Int_t ForestReader::GetNTrackDegreesOfFreedom(Int_t iTrack) const{
-  if(fIsMiniAOD) return -1; // Does not exist in MiniAOD forest
+  if(fIsMiniAOD || fIsSlimForest || fIsMappedForest) return -1; // Does not exist in MiniAOD, slim or mapped forest
+  RequireTrackColumn(kDegreesOfFreedomColumn);
   return fnTrackDegreesOfFreedomArray[iTrack];
 }
 
 // Getter for number of hits in tracker layers
 Int_t ForestReader::GetNHitsTrackerLayer(Int_t iTrack) const{
-  if(fIsMiniAOD) return fnHitsTrackerLayerVector->at(iTrack);
-  return fnHitsTrackerLayerArray[iTrack];
+  RequireTrackColumn(kHitsTrackerLayerColumn);
+  return fEventView.fTrackHitsTrackerLayer[iTrack];
 }
 
 // Getter for number of hits for the track
 Int_t ForestReader::GetNHitsTrack(Int_t iTrack) const{
-  if(fIsMiniAOD) return fnHitsTrackVector->at(iTrack);
-  return fnHitsTrackArray[iTrack];
+  RequireTrackColumn(kHitsTrackColumn);
+  return fEventView.fTrackHits[iTrack];
 }
 
 // Getter for track energy in ECal
 Float_t ForestReader::GetTrackEnergyEcal(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackEnergyEcalVector->at(iTrack);
-  return fTrackEnergyEcalArray[iTrack];
+  RequireTrackColumn(kEnergyEcalColumn);
+  return fEventView.fTrackEnergyEcal[iTrack];
 }
 
 // Getter for track energy in HCal
 Float_t ForestReader::GetTrackEnergyHcal(Int_t iTrack) const{
-  if(fIsMiniAOD) return fTrackEnergyHcalVector->at(iTrack);
-  return fTrackEnergyHcalArray[iTrack];
+  RequireTrackColumn(kEnergyHcalColumn);
+  return fEventView.fTrackEnergyHcal[iTrack];
 }
 
 // Getter for number of generator level particles
@@ -1043,25 +2107,25 @@ Int_t ForestReader::GetNGenParticles() const{
 
 // Getter for generator level particle pT
 Float_t ForestReader::GetGenParticlePt(Int_t iTrack) const{
-  return fGenParticlePtArray->at(iTrack);
+  return fEventView.fGenParticlePt[iTrack];
 }
 
 // Getter for generator level particle phi
 Float_t ForestReader::GetGenParticlePhi(Int_t iTrack) const{
-  return fGenParticlePhiArray->at(iTrack);
+  return fEventView.fGenParticlePhi[iTrack];
 }
 
 // Getter for generator level particle eta
 Float_t ForestReader::GetGenParticleEta(Int_t iTrack) const{
-  return fGenParticleEtaArray->at(iTrack);
+  return fEventView.fGenParticleEta[iTrack];
 }
 
 // Getter for generator level particle charge
 Int_t ForestReader::GetGenParticleCharge(Int_t iTrack) const{
-  return fGenParticleChargeArray->at(iTrack);
+  return fEventView.fGenParticleCharge[iTrack];
 }
 
 // Getter for generator level particle subevent index
 Int_t ForestReader::GetGenParticleSubevent(Int_t iTrack) const{
-  return fGenParticleSubeventArray->at(iTrack);
+  return fEventView.fGenParticleSubevent[iTrack];
 }
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 
 // Root includes
 #include <TString.h>
@@ -20,20 +21,72 @@
 #include <TChain.h>
 #include <TBranch.h>
 #include <TFile.h>
+#include <TROOT.h>
+#include <TEnv.h>
+#include <TTreePerfStats.h>
+
+// Own includes
+#include "MappedForestFile.h"
 
 using namespace std;
 
 class ForestReader{
   
 private:
-  static const Int_t fnMaxJet = 250;        // Maximum number of jets in an event
-  static const Int_t fnMaxTrack = 60000;    // Maximum number of tracks in an event
+  static const Int_t fnMaxJet = 250;        // Old fixed number of jets in an event. Larger events are reported.
+  static const Int_t fnMaxTrack = 60000;    // Old fixed number of tracks in an event. Larger events are reported.
+  static const Int_t fnInitialJets = 64;    // Initial size of the jet buffers
+  static const Int_t fnInitialTracks = 2048; // Initial size of the track buffers
+  static const Int_t fBufferGranularity = 64; // Buffer sizes are rounded up to a multiple of this
   
 public:
   
   // Possible data types to be read with the reader class
   enum enumDataTypes{kPp, kPbPb, kPpMC, kPbPbMC, knDataTypes};
   
+  // Trees in the forest. Used for dividing the read cache budget between the trees and for the decompression statistics.
+  enum enumForestTrees{kHeavyIonTree, kHltTree, kSkimTree, kJetTree, kTrackTree, kGenParticleTree, kSlimForestTree, knForestTrees};
+  
+  // Columns in the track tree that can be read on demand
+  enum enumTrackColumns{kTrackPtColumn, kTrackPtErrorColumn, kTrackPhiColumn, kTrackEtaColumn, kHighPurityColumn, kVertexDistanceZColumn, kVertexDistanceZErrorColumn, kVertexDistanceXYColumn, kVertexDistanceXYErrorColumn, kChi2Column, kDegreesOfFreedomColumn, kHitsTrackerLayerColumn, kHitsTrackColumn, kEnergyEcalColumn, kEnergyHcalColumn, knTrackColumns};
+  static const Int_t kAllTrackColumns = (1 << knTrackColumns) - 1; // Bitmask of all the track columns for GetEventView
+  
+  // Flat arrays for all the jets, tracks and generator level particles in the current event. The same view is
+  // given for AOD, MiniAOD, slim and mapped forests, such that the analysis loops do not need to know the input type.
+  struct EventView{
+    Int_t fnJets;                               // Number of jets
+    Int_t fnGenJets;                            // Number of generator level jets
+    Int_t fnTracks;                             // Number of tracks
+    Int_t fnGenParticles;                       // Number of generator level particles
+    const Float_t *fJetPt;                      // Jet pT:s
+    const Float_t *fJetPhi;                     // Jet phis
+    const Float_t *fJetEta;                     // Jet etas
+    const Float_t *fJetRawPt;                   // Raw jet pT:s
+    const Float_t *fJetMaxTrackPt;              // Maximum track pT inside the jets
+    const Float_t *fGenJetPt;                   // Generator level jet pT:s
+    const Float_t *fGenJetPhi;                  // Generator level jet phis
+    const Float_t *fGenJetEta;                  // Generator level jet etas
+    const Float_t *fTrackPt;                    // Track pT:s
+    const Float_t *fTrackPtError;               // Track pT errors
+    const Float_t *fTrackPhi;                   // Track phis
+    const Float_t *fTrackEta;                   // Track etas
+    const Bool_t *fTrackHighPurity;             // High purity of tracks
+    const Float_t *fTrackVertexDistanceZ;       // Track distance from primary vertex in z-direction
+    const Float_t *fTrackVertexDistanceZError;  // Error for track distance from primary vertex in z-direction
+    const Float_t *fTrackVertexDistanceXY;      // Track distance from primary vertex in xy-direction
+    const Float_t *fTrackVertexDistanceXYError; // Error for track distance from primary vertex in xy-direction
+    const Float_t *fTrackNormalizedChi2;        // Normalized track chi2 value from reconstruction fit
+    const UChar_t *fTrackHitsTrackerLayer;      // Number of hits in tracker layers
+    const UChar_t *fTrackHits;                  // Number of hits for the track
+    const Float_t *fTrackEnergyEcal;            // Track energy in ECal
+    const Float_t *fTrackEnergyHcal;            // Track energy in HCal
+    const Float_t *fGenParticlePt;              // Generator level particle pT:s
+    const Float_t *fGenParticlePhi;             // Generator level particle phis
+    const Float_t *fGenParticleEta;             // Generator level particle etas
+    const Int_t *fGenParticleCharge;            // Generator level particle charges
+    const Int_t *fGenParticleSubevent;          // Generator level particle subevent indices
+  };
+  
   // Constructors and destructors
   ForestReader();                                          // Default constructor
   ForestReader(Int_t dataType, Int_t jetType, Int_t jetAxis, Bool_t useTrigger); // Custom constructor
@@ -43,10 +96,16 @@ public:
   
   // Methods
   void GetEvent(Int_t nEvent);                 // Get the nth event in tree
+  void GetEventInformation(Int_t nEvent);      // Get only the event level information for the nth event in tree
+  void GetEventContent();                      // Get the jets, tracks and particles for the event read with GetEventInformation
   Int_t GetNEvents() const;                        // Get the number of events
   void ReadForestFromFile(TFile *inputFile);   // Read the forest from a file
   void ReadForestFromFileList(std::vector<TString> fileList);   // Read the forest from a file list
+  void ReadMappedForestFromFile(const char *fileName); // Map a forest written in the mapped format to memory
   void BurnForest();                           // Burn the forest
+  void DisconnectForest();                     // Stop reading the current forest before its file is closed
+  void PrintTrackColumnReadStatistics() const; // Print the number of bytes read from each track column
+  void PrintTreeUnzipTimes();                  // Print the time spent decompressing the baskets of each forest tree
   
   // Getters for leaves in heavy ion tree
   Float_t GetVz() const;              // Getter for vertex z position
@@ -96,6 +155,10 @@ public:
   Float_t GetTrackEnergyEcal(Int_t iTrack) const;            // Getter for track energy in ECal
   Float_t GetTrackEnergyHcal(Int_t iTrack) const;            // Getter for track energy in HCal
   
+  // Getter for all the jets, tracks and generator level particles of the current event as flat arrays. When reading
+  // track columns on demand, only the columns in the bitmask of enumTrackColumns are guaranteed to be read.
+  const EventView& GetEventView(Int_t trackColumns = kAllTrackColumns) const;
+  
   // Getters for leaves in generator level particle tree
   Int_t GetNGenParticles() const;                            // Getter for number of generator level particles
   Float_t GetGenParticlePt(Int_t iTrack) const;              // Getter for generator level particle pT
@@ -106,17 +169,58 @@ public:
   
   // Setter for data type
   void SetDataType(Int_t dataType); // Setter for data type
+  void SetReadTrackColumnsOnDemand(Bool_t onDemand); // Setter for reading track columns only when they are needed
+  void SetTreeCacheSize(Long64_t cacheSize);         // Setter for the total read cache budget shared by the forest trees
+  void SetAsyncPrefetching(Bool_t asyncPrefetch);    // Setter for asynchronous prefetching of the next cluster to the read cache
+  void SetNumberOfThreads(Int_t nThreads);           // Setter for the number of threads used to decompress the baskets
   
 private:
   
   // Methods
   void Initialize();      // Connect the branches to the tree
+  void InitializeSlimForest();       // Connect the branches to the slim forest tree
+  void CollectTrackColumnBranches(); // Collect the connected track branches to the column table
+  void ResetEventView();  // Point the event view to the branch buffers of this reader
+  void UpdateEventView(); // Update the event view after the event content has been read
+  void UpdateTrackColumnView(const Int_t iColumn) const; // Update one track column in the event view after it has been read
+  void SetupTreeCaches(); // Set up the read caches for the branches connected in Initialize
+  void SetupTreeCache(TTree *tree, const Long64_t cacheSize, const std::vector<TBranch*> &branches); // Set up the read cache for the given branches of one tree
+  void GetReadBranches(const Int_t iTree, std::vector<TBranch*> &branches) const; // List the branches read from one forest tree
+  void SetupTreeDecompression(); // Enable parallel decompression and decompression statistics for the trees in use
+  void CollectTreeUnzipTimes();  // Add the decompression times of the connected trees to the totals
+  void GetForestTrees(TTree *forestTrees[knForestTrees], Bool_t treeInUse[knForestTrees]) const; // List the forest trees and the ones read by the reader
+  Bool_t ReserveJetBuffers(const Int_t nJets);     // Make sure that the jet buffers can hold the given number of jets
+  Bool_t ReserveTrackBuffers(const Int_t nTracks); // Make sure that the track buffers can hold the given number of tracks
+  void AllocateJetBuffers(const Int_t bufferSize);   // Replace the jet buffers with buffers of the given size
+  void AllocateTrackBuffers(const Int_t bufferSize); // Replace the track buffers with buffers of the given size
+  void ConnectJetBuffers();   // Point the jet branches to the current jet buffers
+  void ConnectTrackBuffers(); // Point the track branches to the current track buffers
+  void LoadTrackColumn(const Int_t iColumn) const;  // Read the current entry of a track column from the file
+  
+  // Make sure that the given track column is read for the current event
+  void RequireTrackColumn(const Int_t iColumn) const{
+    if(!fTrackColumnLoaded[iColumn]) LoadTrackColumn(iColumn);
+  }
     
   Int_t fDataType;        // Type of data read with the tree. 0 = pp, 1 = PbPb, 2 = ppMC, 3 = PbPbMC
   Int_t fJetType;         // Choose the type of jets usedfor analysis. 0 = Calo jets, 1 = PF jets
   Int_t fJetAxis;         // Jet axis used for the jets. 0 = Anti-kT, 1 = WTA
   Bool_t fUseTrigger;     // Flag for applying jet trigger selection to the analysis
   Bool_t fIsMiniAOD;      // Flag for type of the forest True = MiniAOD forest, False = AOD forest
+  Bool_t fIsSlimForest;   // Flag for slim forest produced by slimForestConverter. All the information is in a single tree.
+  Bool_t fIsMappedForest; // Flag for mapped forest produced by slimForestConverter. The data is read directly from the mapped file.
+  MappedForestFile *fMappedForest; // Memory-mapped forest file
+  Int_t fCurrentEvent;    // Index of the event for which the event level information has been read
+  Bool_t fReadTrackColumnsOnDemand; // Flag for reading each track column only when a getter first asks for it
+  
+  // Read cache configuration
+  Long64_t fTreeCacheSize;  // Total size of the TTreeCaches for all the forest trees in bytes. 0 = Do not set up the caches.
+  Bool_t fAsyncPrefetch;    // Flag for prefetching the baskets of the next cluster asynchronously
+  
+  // Parallel decompression of the baskets
+  Int_t fNumberOfThreads;                          // Number of threads for ROOT implicit multithreading. 1 = Decompress in the reading thread.
+  TTreePerfStats *fTreePerfStats[knForestTrees];   // Decompression statistics for the trees of the current file
+  Double_t fTreeUnzipTime[knForestTrees];          // Time spent decompressing baskets of each tree in the previous files, summed over threads
   
   // Trees in the forest
   TTree *fHeavyIonTree;    // Tree for heavy ion event information
@@ -125,6 +229,7 @@ private:
   TTree *fSkimTree;        // Tree for event selection information
   TTree *fTrackTree;       // Tree for reconstructed tracks
   TTree *fGenParticleTree; // Tree for generator level particles
+  TTree *fSlimForestTree;  // Single tree containing all the information in a slim forest
   
   // Branches for heavy ion tree
   TBranch *fHiVzBranch;                   // Branch for vertex z-position
@@ -171,6 +276,11 @@ private:
   TBranch *fnHitsTrackBranch;                 // Branch for number of hits for the track
   TBranch *fTrackEnergyEcalBranch;            // Branch for track energy in ECal
   TBranch *fTrackEnergyHcalBranch;            // Branch for track energy in HCal
+  TBranch *fTrackColumnBranches[knTrackColumns]; // Track branches indexed by enumTrackColumns
+  
+  // Branches in slim forest
+  std::vector<TBranch*> fSlimEventBranches;   // Branches for event level information in slim forest
+  std::vector<TBranch*> fSlimContentBranches; // Branches for jets and generator level information in slim forest
   
   // Branches for genenerator level particle tree
   TBranch *fGenParticlePtBranch;         // Branch for generator level particle pT:s
@@ -189,15 +299,16 @@ private:
   Int_t fnGenJets;       // Number of generator level jets in an event
   Float_t fEventWeight;  // jet weight in the MC tree
   
-  Float_t fJetPtArray[fnMaxJet] = {0};         // pT:s of all the jets in an event
-  Float_t fJetPhiArray[fnMaxJet] = {0};        // phis of all the jets in an event
-  Float_t fJetEtaArray[fnMaxJet] = {0};        // etas of all the jets in an event
-  Float_t fJetRawPtArray[fnMaxJet] = {0};      // raw jet pT for all the jets in an event
-  Float_t fJetMaxTrackPtArray[fnMaxJet] = {0}; // maximum track pT inside a jet for all the jets in an event
+  Int_t fJetBufferSize;          // Number of jets that fit to the jet and generator level jet buffers
+  Float_t *fJetPtArray;          // pT:s of all the jets in an event
+  Float_t *fJetPhiArray;         // phis of all the jets in an event
+  Float_t *fJetEtaArray;         // etas of all the jets in an event
+  Float_t *fJetRawPtArray;       // raw jet pT for all the jets in an event
+  Float_t *fJetMaxTrackPtArray;  // maximum track pT inside a jet for all the jets in an event
   
-  Float_t fGenJetPtArray[fnMaxJet] = {0};      // pT:s of the generator level jets in an event
-  Float_t fGenJetPhiArray[fnMaxJet] = {0};     // phis of the generator level jets in an event
-  Float_t fGenJetEtaArray[fnMaxJet] = {0};     // etas of the generator level jets in an event
+  Float_t *fGenJetPtArray;       // pT:s of the generator level jets in an event
+  Float_t *fGenJetPhiArray;      // phis of the generator level jets in an event
+  Float_t *fGenJetEtaArray;      // etas of the generator level jets in an event
   
   // Leaves for the HLT tree
   Int_t fJetFilterBit;  // Filter bit for the jet trigger
@@ -211,22 +322,24 @@ private:
   // Leaves for the track tree regardless of forest type
   Int_t fnTracks;  // Number of tracks
   
-  // Leaves for the track tree in AOD forests
-  Float_t fTrackPtArray[fnMaxTrack] = {0};                    // Array for track pT:s
-  Float_t fTrackPtErrorArray[fnMaxTrack] = {0};               // Array for track pT errors
-  Float_t fTrackPhiArray[fnMaxTrack] = {0};                   // Array for track phis
-  Float_t fTrackEtaArray[fnMaxTrack] = {0};                   // Array for track etas
-  Bool_t fHighPurityTrackArray[fnMaxTrack] = {0};             // Array for the high purity of tracks
-  Float_t fTrackVertexDistanceZArray[fnMaxTrack] = {0};       // Array for track distance from primary vertex in z-direction
-  Float_t fTrackVertexDistanceZErrorArray[fnMaxTrack] = {0};  // Array for error for track distance from primary vertex in z-direction
-  Float_t fTrackVertexDistanceXYArray[fnMaxTrack] = {0};      // Array for track distance from primary vertex in xy-direction
-  Float_t fTrackVertexDistanceXYErrorArray[fnMaxTrack] = {0}; // Array for error for track distance from primary vertex in xy-direction
-  Float_t fTrackChi2Array[fnMaxTrack] = {0};                  // Array for track chi2 value from reconstruction fit
-  UChar_t fnTrackDegreesOfFreedomArray[fnMaxTrack] = {0};     // Array for number of degrees of freedom in reconstruction fit
-  UChar_t fnHitsTrackerLayerArray[fnMaxTrack] = {0};          // Array for number of hits in tracker layers
-  UChar_t fnHitsTrackArray[fnMaxTrack] = {0};                 // Array for number of hits for the track
-  Float_t fTrackEnergyEcalArray[fnMaxTrack] = {0};            // Array for track energy in ECal
-  Float_t fTrackEnergyHcalArray[fnMaxTrack] = {0};            // Array for track energy in HCal
+  // Leaves for the track tree in AOD forests. The buffers grow to the largest event seen.
+  Int_t fTrackBufferSize;                    // Number of tracks that fit to the track buffers
+  Float_t *fTrackPtArray;                    // Array for track pT:s
+  Float_t *fTrackPtErrorArray;               // Array for track pT errors
+  Float_t *fTrackPhiArray;                   // Array for track phis
+  Float_t *fTrackEtaArray;                   // Array for track etas
+  Bool_t *fHighPurityTrackArray;             // Array for the high purity of tracks. Filled from the vector in MiniAOD.
+  Float_t *fTrackVertexDistanceZArray;       // Array for track distance from primary vertex in z-direction
+  Float_t *fTrackVertexDistanceZErrorArray;  // Array for error for track distance from primary vertex in z-direction
+  Float_t *fTrackVertexDistanceXYArray;      // Array for track distance from primary vertex in xy-direction
+  Float_t *fTrackVertexDistanceXYErrorArray; // Array for error for track distance from primary vertex in xy-direction
+  Float_t *fTrackChi2Array;                  // Array for track chi2 value from reconstruction fit
+  Float_t *fTrackNormalizedChi2Array;        // Array for normalized track chi2 value. Read from slim forest, calculated for AOD.
+  UChar_t *fnTrackDegreesOfFreedomArray;     // Array for number of degrees of freedom in reconstruction fit
+  UChar_t *fnHitsTrackerLayerArray;          // Array for number of hits in tracker layers
+  UChar_t *fnHitsTrackArray;                 // Array for number of hits for the track
+  Float_t *fTrackEnergyEcalArray;            // Array for track energy in ECal
+  Float_t *fTrackEnergyHcalArray;            // Array for track energy in HCal
   
   // Leaves for the track tree in MiniAOD forests
   vector<float> *fTrackPtVector;                    // Vector for track pT:s
@@ -244,6 +357,16 @@ private:
   vector<float> *fTrackEnergyEcalVector;            // Vector for track energy in ECal
   vector<float> *fTrackEnergyHcalVector;            // Vector for track energy in HCal
   
+  // Struct-of-arrays view of the current event. Points to the branch buffers or directly to the mapped forest file.
+  mutable EventView fEventView;
+  mutable Bool_t fNormalizedChi2Ready; // Flag telling if the AOD chi2 is normalized for the current event
+  
+  // Bookkeeping for reading the track columns on demand
+  mutable Bool_t fTrackColumnLoaded[knTrackColumns];        // Flag telling if the column is read for the current event
+  mutable Long64_t fTrackColumnBytesRead[knTrackColumns];   // Number of bytes read from each track column
+  mutable Long64_t fTrackColumnEntriesRead[knTrackColumns]; // Number of events for which each track column is read
+  Long64_t fnTrackEventsRead;                               // Number of events for which the track tree is accessed
+  
   // Leaves for the generator level particle tree
   Int_t fnGenParticles;                     // Number of generator level particles
   vector<float> *fGenParticlePtArray;       // Array for generator level particle pT:s
@@ -0,0 +1,353 @@
+// Implementation of the memory-mapped event file
+
+// C++ includes
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+// Own includes
+#include "MappedForestFile.h"
+
+// Identifier for the file format
+static const char kMappedForestMagic[8] = {'T','P','E','F','M','A','P','1'};
+static const Int_t kMappedForestVersion = 1;
+
+// Size of one element in each column in bytes
+const Int_t MappedForestFile::fColumnElementSize[knColumns] = {
+  sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Float_t),  // Jets
+  sizeof(Float_t), sizeof(Float_t), sizeof(Float_t),                                    // Generator level jets
+  sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Bool_t),   // Track kinematics and purity
+  sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Float_t),  // Track vertex distances and chi2
+  sizeof(UChar_t), sizeof(UChar_t), sizeof(Float_t), sizeof(Float_t),                   // Track hits and calorimeter energies
+  sizeof(Float_t), sizeof(Float_t), sizeof(Float_t), sizeof(Int_t), sizeof(Int_t)       // Generator level particles
+};
+
+// Collection defining the length of each column
+const Int_t MappedForestFile::fColumnCollection[knColumns] = {
+  kJets, kJets, kJets, kJets, kJets,
+  kGenJets, kGenJets, kGenJets,
+  kTracks, kTracks, kTracks, kTracks, kTracks,
+  kTracks, kTracks, kTracks, kTracks, kTracks,
+  kTracks, kTracks, kTracks, kTracks,
+  kGenParticles, kGenParticles, kGenParticles, kGenParticles, kGenParticles
+};
+
+/*
+ * Default constructor
+ */
+MappedForestFile::MappedForestFile() :
+  fFileName(""),
+  fFileDescriptor(-1),
+  fMappedData(0),
+  fMappedSize(0),
+  fnEvents(0),
+  fIndexOffset(0),
+  fEventIndex(0),
+  fCurrentHeader(0),
+  fOutputStream(),
+  fWrittenEventOffsets(0)
+{
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    fCurrentColumns[iColumn] = 0;
+  }
+}
+
+/*
+ * Copy constructor. The copy maps the same file again.
+ */
+MappedForestFile::MappedForestFile(const MappedForestFile& in) :
+  fFileName(""),
+  fFileDescriptor(-1),
+  fMappedData(0),
+  fMappedSize(0),
+  fnEvents(0),
+  fIndexOffset(0),
+  fEventIndex(0),
+  fCurrentHeader(0),
+  fOutputStream(),
+  fWrittenEventOffsets(0)
+{
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    fCurrentColumns[iColumn] = 0;
+  }
+
+  if(in.fMappedData) Open(in.fFileName);
+}
+
+/*
+ * Destructor
+ */
+MappedForestFile::~MappedForestFile(){
+  Close();
+  if(fOutputStream.is_open()) CloseForWriting();
+}
+
+/*
+ * Equal sign operator. Maps the same file again.
+ */
+MappedForestFile& MappedForestFile::operator=(const MappedForestFile& in){
+  if(&in == this) return *this;
+
+  Close();
+  if(in.fMappedData) Open(in.fFileName);
+
+  return *this;
+}
+
+/*
+ * Map a file to memory for reading
+ *
+ *  Arguments:
+ *   const char *fileName = Name of the mapped forest file
+ */
+void MappedForestFile::Open(const char *fileName){
+
+  // Close the previously mapped file
+  Close();
+
+  fFileDescriptor = open(fileName, O_RDONLY);
+  if(fFileDescriptor < 0){
+    cout << "Error! Could not open the file: " << fileName << endl;
+    assert(0);
+  }
+
+  struct stat fileStatus;
+  if(fstat(fFileDescriptor, &fileStatus) != 0){
+    cout << "Error! Could not find the size of the file: " << fileName << endl;
+    assert(0);
+  }
+  fMappedSize = fileStatus.st_size;
+
+  if(fMappedSize < (Long64_t)sizeof(FileHeader)){
+    cout << "Error! The file " << fileName << " is too small to be a mapped forest file." << endl;
+    assert(0);
+  }
+
+  // The pages are shared with all the processes mapping the same file
+  void *mapping = mmap(NULL, fMappedSize, PROT_READ, MAP_SHARED, fFileDescriptor, 0);
+  if(mapping == MAP_FAILED){
+    cout << "Error! Could not map the file: " << fileName << endl;
+    assert(0);
+  }
+  fMappedData = (const char*)mapping;
+  fFileName = fileName;
+
+  // Events are read sequentially
+  madvise(mapping, fMappedSize, MADV_SEQUENTIAL);
+
+  // Check that the file is in the expected format
+  const FileHeader *fileHeader = (const FileHeader*)fMappedData;
+  if(memcmp(fileHeader->fMagic, kMappedForestMagic, sizeof(kMappedForestMagic)) != 0 || fileHeader->fVersion != kMappedForestVersion){
+    cout << "Error! The file " << fileName << " is not a mapped forest file of version " << kMappedForestVersion << endl;
+    assert(0);
+  }
+  if(fileHeader->fByteOrderCheck != fByteOrderCheckValue){
+    cout << "Error! The file " << fileName << " is written with different byte order than this machine uses." << endl;
+    assert(0);
+  }
+
+  // The event index must be inside the file, after the file header
+  const Long64_t firstEventOffset = PadToAlignment(sizeof(FileHeader));
+  const Long64_t indexOffset = fileHeader->fIndexOffset;
+  const Long64_t nEvents = fileHeader->fnEvents;
+  if(nEvents < 0 || indexOffset < firstEventOffset || indexOffset % sizeof(Long64_t) != 0 || indexOffset > fMappedSize || nEvents > (fMappedSize - indexOffset) / (Long64_t)sizeof(Long64_t)){
+    cout << "Error! The event index of " << nEvents << " events at " << indexOffset << " does not fit to the file " << fileName << " of " << fMappedSize << " bytes." << endl;
+    Close();
+    assert(0);
+    return;
+  }
+
+  fnEvents = nEvents;
+  fIndexOffset = indexOffset;
+  fEventIndex = (const Long64_t*)(fMappedData + fIndexOffset);
+
+  // Each event block must start at an aligned position between the file header and the event index
+  for(Long64_t iEvent = 0; iEvent < fnEvents; iEvent++){
+    if(fEventIndex[iEvent] < firstEventOffset || fEventIndex[iEvent] % fAlignment != 0 || fEventIndex[iEvent] > fIndexOffset - PadToAlignment(sizeof(EventHeader))){
+      cout << "Error! Event " << iEvent << " has an invalid offset " << fEventIndex[iEvent] << " in the file " << fileName << endl;
+      Close();
+      assert(0);
+      return;
+    }
+  }
+}
+
+/*
+ * Unmap the file
+ */
+void MappedForestFile::Close(){
+  if(fMappedData) munmap((void*)fMappedData, fMappedSize);
+  if(fFileDescriptor >= 0) close(fFileDescriptor);
+
+  fFileDescriptor = -1;
+  fMappedData = 0;
+  fMappedSize = 0;
+  fnEvents = 0;
+  fIndexOffset = 0;
+  fEventIndex = 0;
+  fCurrentHeader = 0;
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    fCurrentColumns[iColumn] = 0;
+  }
+}
+
+// Getter for the number of events in the file
+Long64_t MappedForestFile::GetNEvents() const{
+  return fnEvents;
+}
+
+/*
+ * Find the header and columns of an event from the mapped file. No data is copied. The columns given by the
+ * numbers of objects in the header must end before the event index, such that no column is read past the file.
+ *
+ *  Arguments:
+ *   const Long64_t iEvent = Index of the event in the file
+ */
+void MappedForestFile::ReadEvent(const Long64_t iEvent){
+  if(iEvent < 0 || iEvent >= fnEvents){
+    cout << "Error! Event " << iEvent << " is not in the file " << fFileName.Data() << " with " << fnEvents << " events." << endl;
+    assert(0);
+    SetEmptyEvent();
+    return;
+  }
+
+  const char *eventBlock = fMappedData + fEventIndex[iEvent];
+  fCurrentHeader = (const EventHeader*)eventBlock;
+
+  for(Int_t iCollection = 0; iCollection < knCollections; iCollection++){
+    if(fCurrentHeader->fnObjects[iCollection] < 0){
+      cout << "Error! Event " << iEvent << " has a negative number of objects in the file " << fFileName.Data() << endl;
+      assert(0);
+      SetEmptyEvent();
+      return;
+    }
+  }
+
+  // The columns follow the header in the order given by enumColumns
+  Long64_t position = PadToAlignment(sizeof(EventHeader));
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    fCurrentColumns[iColumn] = eventBlock + position;
+    position += PadToAlignment((Long64_t)fCurrentHeader->fnObjects[fColumnCollection[iColumn]] * fColumnElementSize[iColumn]);
+  }
+
+  if(position > fIndexOffset - fEventIndex[iEvent]){
+    cout << "Error! The block of event " << iEvent << " with " << position << " bytes does not fit to the file " << fFileName.Data() << endl;
+    assert(0);
+    SetEmptyEvent();
+  }
+}
+
+/*
+ * Make the current event an event without any objects. Used instead of an event block that is not valid, when the
+ * program is compiled without the assertions.
+ */
+void MappedForestFile::SetEmptyEvent(){
+  static const EventHeader emptyHeader = {};
+  fCurrentHeader = &emptyHeader;
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    fCurrentColumns[iColumn] = &emptyHeader;
+  }
+}
+
+// Getter for the header of the current event
+const MappedForestFile::EventHeader* MappedForestFile::GetEventHeader() const{
+  return fCurrentHeader;
+}
+
+// Getter for one column of the current event
+const void* MappedForestFile::GetColumn(const Int_t iColumn) const{
+  return fCurrentColumns[iColumn];
+}
+
+/*
+ * Create a new file for writing
+ *
+ *  Arguments:
+ *   const char *fileName = Name of the created file
+ */
+void MappedForestFile::OpenForWriting(const char *fileName){
+
+  fOutputStream.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!fOutputStream.is_open()){
+    cout << "Error! Could not open the file " << fileName << " for writing." << endl;
+    assert(0);
+  }
+  fWrittenEventOffsets.clear();
+
+  // Reserve space for the file header. It is filled when the file is closed.
+  char emptyBlock[fAlignment] = {0};
+  fOutputStream.write(emptyBlock, PadToAlignment(sizeof(FileHeader)));
+}
+
+/*
+ * Write one event to the file
+ *
+ *  Arguments:
+ *   const EventHeader &header = Scalar information and the numbers of objects in the event
+ *   const void *columns[knColumns] = Data for each column. The lengths are given by the numbers of objects in the header.
+ */
+void MappedForestFile::WriteEvent(const EventHeader &header, const void *columns[knColumns]){
+
+  char emptyBlock[fAlignment] = {0};
+  fWrittenEventOffsets.push_back(fOutputStream.tellp());
+
+  // Write the header
+  fOutputStream.write((const char*)&header, sizeof(EventHeader));
+  fOutputStream.write(emptyBlock, PadToAlignment(sizeof(EventHeader)) - sizeof(EventHeader));
+
+  // Write the columns, each padded to the alignment
+  Long64_t columnSize;
+  for(Int_t iColumn = 0; iColumn < knColumns; iColumn++){
+    columnSize = (Long64_t)header.fnObjects[fColumnCollection[iColumn]] * fColumnElementSize[iColumn];
+    if(columnSize > 0) fOutputStream.write((const char*)columns[iColumn], columnSize);
+    fOutputStream.write(emptyBlock, PadToAlignment(columnSize) - columnSize);
+  }
+}
+
+/*
+ * Write the event index and the file header and close the file
+ */
+void MappedForestFile::CloseForWriting(){
+
+  // Write the event index to the end of the file
+  FileHeader fileHeader;
+  memcpy(fileHeader.fMagic, kMappedForestMagic, sizeof(kMappedForestMagic));
+  fileHeader.fVersion = kMappedForestVersion;
+  fileHeader.fByteOrderCheck = fByteOrderCheckValue;
+  fileHeader.fnEvents = fWrittenEventOffsets.size();
+  fileHeader.fIndexOffset = fOutputStream.tellp();
+  if(fileHeader.fnEvents > 0) fOutputStream.write((const char*)fWrittenEventOffsets.data(), fileHeader.fnEvents * sizeof(Long64_t));
+
+  // Fill the file header to the reserved space in the beginning of the file
+  fOutputStream.seekp(0);
+  fOutputStream.write((const char*)&fileHeader, sizeof(FileHeader));
+  fOutputStream.close();
+
+  fWrittenEventOffsets.clear();
+}
+
+/*
+ * Check from the file name if a file is a mapped forest file
+ *
+ *  Arguments:
+ *   const TString fileName = Name of the file
+ *
+ *   return: True for files with the extension .mforest, false otherwise
+ */
+Bool_t MappedForestFile::IsMappedForestFile(const TString fileName){
+  return fileName.EndsWith(".mforest");
+}
+
+/*
+ * Round the size up to full alignment blocks
+ *
+ *  Arguments:
+ *   const Long64_t size = Size in bytes
+ *
+ *   return: Smallest multiple of the alignment not smaller than the given size
+ */
+Long64_t MappedForestFile::PadToAlignment(const Long64_t size){
+  return ((size + fAlignment - 1) / fAlignment) * fAlignment;
+}
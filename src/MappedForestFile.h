@@ -0,0 +1,110 @@
+// Class for reading and writing the memory-mapped event file used as the fastest input format for local reruns
+//
+//===========================================================
+// MappedForestFile.h
+//
+// The file contains the same information as the slim forest, but without any compression or serialization.
+// Each event is one block: an event header with all the scalar information followed by the jet, generator
+// level jet, track and generator level particle columns. Every column starts at a 32 byte aligned offset, such
+// that the columns can be read directly from the mapped pages. An index of the event block offsets is written
+// to the end of the file. The values are stored in the native byte order of the machine writing the file.
+//===========================================================
+
+#ifndef MAPPEDFORESTFILE_H
+#define MAPPEDFORESTFILE_H
+
+// C++ includes
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <assert.h>
+
+// Root includes
+#include <TString.h>
+
+using namespace std;
+
+class MappedForestFile{
+
+public:
+
+  // Columns stored for each event
+  enum enumColumns{kJetPt, kJetPhi, kJetEta, kJetRawPt, kJetMaxTrackPt, kGenJetPt, kGenJetPhi, kGenJetEta, kTrackPt, kTrackPtError, kTrackPhi, kTrackEta, kTrackHighPurity, kTrackVertexDistanceZ, kTrackVertexDistanceZError, kTrackVertexDistanceXY, kTrackVertexDistanceXYError, kTrackNormalizedChi2, kTrackHitsTrackerLayer, kTrackHits, kTrackEnergyEcal, kTrackEnergyHcal, kGenParticlePt, kGenParticlePhi, kGenParticleEta, kGenParticleCharge, kGenParticleSubevent, knColumns};
+
+  // Object collections defining the length of the columns
+  enum enumCollections{kJets, kGenJets, kTracks, kGenParticles, knCollections};
+
+  // Scalar information for one event. Followed by the columns in the event block.
+  struct EventHeader{
+    Float_t fVertexZ;                     // Vertex z-position
+    Int_t fHiBin;                         // HiBin = Centrality percentile * 2
+    Float_t fPtHat;                       // pT hat
+    Float_t fEventWeight;                 // Event weight in MC
+    Int_t fJetFilterBit;                  // Filter bit for the jet trigger
+    Int_t fPrimaryVertexFilterBit;        // Filter bit for primary vertex
+    Int_t fBeamScrapingFilterBit;         // Filter bit for beam scraping
+    Int_t fHfCoincidenceFilterBit;        // Filter bit for energy recorded in at least 3 HF calorimeter towers
+    Int_t fClusterCompatibilityFilterBit; // Filter bit for cluster compatibility
+    Int_t fnObjects[knCollections];       // Number of jets, generator level jets, tracks and generator level particles
+    Int_t fPadding[3];                    // Pad the header to 64 bytes
+  };
+
+  // Constructors and destructor
+  MappedForestFile();                                  // Default constructor
+  MappedForestFile(const MappedForestFile& in);        // Copy constructor
+  ~MappedForestFile();                                 // Destructor
+  MappedForestFile& operator=(const MappedForestFile& obj); // Equal sign operator
+
+  // Methods for reading
+  void Open(const char *fileName);                     // Map a file to memory for reading
+  void Close();                                        // Unmap the file
+  Long64_t GetNEvents() const;                         // Get the number of events in the file
+  void ReadEvent(const Long64_t iEvent);               // Find the header and columns of an event from the mapped file
+  const EventHeader* GetEventHeader() const;           // Get the header of the current event
+  const void* GetColumn(const Int_t iColumn) const;    // Get the data of one column for the current event
+
+  // Methods for writing
+  void OpenForWriting(const char *fileName);           // Create a new file for writing
+  void WriteEvent(const EventHeader &header, const void *columns[knColumns]); // Write one event to the file
+  void CloseForWriting();                              // Write the event index and close the file
+
+  static Bool_t IsMappedForestFile(const TString fileName); // Check from the file name if a file is a mapped forest file
+
+private:
+
+  // Header in the beginning of the file
+  struct FileHeader{
+    char fMagic[8];         // Identifier for the file format
+    Int_t fVersion;         // Version of the file format
+    Int_t fByteOrderCheck;  // Known integer for checking that the byte order matches
+    Long64_t fnEvents;      // Number of events in the file
+    Long64_t fIndexOffset;  // Position of the event index in the file
+  };
+
+  static const Int_t fAlignment = 32;          // Alignment of the event blocks and columns in bytes
+  static const Int_t fByteOrderCheckValue = 0x01020304; // Value for checking the byte order
+  static const Int_t fColumnElementSize[knColumns];     // Size of one element in each column in bytes
+  static const Int_t fColumnCollection[knColumns];      // Collection defining the length of each column
+
+  // Methods
+  static Long64_t PadToAlignment(const Long64_t size); // Round the size up to full alignment blocks
+  void SetEmptyEvent();                                // Make the current event an event without any objects
+
+  // Reading
+  TString fFileName;                 // Name of the mapped file
+  Int_t fFileDescriptor;             // File descriptor of the mapped file
+  const char *fMappedData;           // Start of the mapped file
+  Long64_t fMappedSize;              // Size of the mapped file in bytes
+  Long64_t fnEvents;                 // Number of events in the mapped file
+  Long64_t fIndexOffset;             // Position of the event index in the mapped file. The event blocks end before it.
+  const Long64_t *fEventIndex;       // Offsets of the event blocks in the mapped file
+  const EventHeader *fCurrentHeader; // Header of the current event
+  const void *fCurrentColumns[knColumns]; // Columns of the current event
+
+  // Writing
+  std::ofstream fOutputStream;       // Stream for writing a new file
+  std::vector<Long64_t> fWrittenEventOffsets; // Offsets of the written event blocks
+
+};
+
+#endif
@@ -0,0 +1,273 @@
+// Implementation of the buffer for the tracks selected for the track pairing
+
+// Own includes
+#include "SelectedTrackBuffer.h"
+
+/*
+ * Default constructor
+ */
+SelectedTrackBuffer::SelectedTrackBuffer() :
+  fnTracks(0),
+  fCapacity(0),
+  fPt(0),
+  fEta(0),
+  fPhi(0),
+  fEfficiency(0),
+  fSortBuffer(0),
+  fSortIndex(),
+  fSortIndexBuffer(),
+  fSortKey(),
+  fSortKeyBuffer(),
+  fRadixCount(1 << fnRadixBits)
+{
+  // Default constructor
+  Allocate(fnInitialTracks);
+}
+
+/*
+ * Copy constructor
+ */
+SelectedTrackBuffer::SelectedTrackBuffer(const SelectedTrackBuffer& in) :
+  fnTracks(0),
+  fCapacity(0),
+  fPt(0),
+  fEta(0),
+  fPhi(0),
+  fEfficiency(0),
+  fSortBuffer(0),
+  fSortIndex(),
+  fSortIndexBuffer(),
+  fSortKey(),
+  fSortKeyBuffer(),
+  fRadixCount(1 << fnRadixBits)
+{
+  // Copy constructor
+  Allocate(in.fCapacity);
+  fnTracks = in.fnTracks;
+  std::copy(in.fPt, in.fPt + fnTracks, fPt);
+  std::copy(in.fEta, in.fEta + fnTracks, fEta);
+  std::copy(in.fPhi, in.fPhi + fnTracks, fPhi);
+  std::copy(in.fEfficiency, in.fEfficiency + fnTracks, fEfficiency);
+}
+
+/*
+ * Destructor
+ */
+SelectedTrackBuffer::~SelectedTrackBuffer(){
+  // Destructor
+  std::free(fPt);
+  std::free(fEta);
+  std::free(fPhi);
+  std::free(fEfficiency);
+  std::free(fSortBuffer);
+}
+
+/*
+ * Equal sign operator
+ */
+SelectedTrackBuffer& SelectedTrackBuffer::operator=(const SelectedTrackBuffer& in){
+  if(&in == this) return *this;
+
+  fnTracks = 0;
+  Reserve(in.fnTracks);
+  fnTracks = in.fnTracks;
+  std::copy(in.fPt, in.fPt + fnTracks, fPt);
+  std::copy(in.fEta, in.fEta + fnTracks, fEta);
+  std::copy(in.fPhi, in.fPhi + fnTracks, fPhi);
+  std::copy(in.fEfficiency, in.fEfficiency + fnTracks, fEfficiency);
+
+  return *this;
+}
+
+/*
+ * Remove all the tracks from the buffer. The memory is kept for the next event.
+ */
+void SelectedTrackBuffer::Clear(){
+  fnTracks = 0;
+}
+
+/*
+ * Add a track to the end of the buffer
+ *
+ *  Arguments:
+ *   const Float_t pt = Track pT
+ *   const Float_t eta = Track eta
+ *   const Float_t phi = Track phi
+ *   const Float_t efficiency = Efficiency correction for the track
+ */
+void SelectedTrackBuffer::AddTrack(const Float_t pt, const Float_t eta, const Float_t phi, const Float_t efficiency){
+  if(fnTracks == fCapacity) Reserve(fnTracks+1);
+  fPt[fnTracks] = pt;
+  fEta[fnTracks] = eta;
+  fPhi[fnTracks] = phi;
+  fEfficiency[fnTracks] = efficiency;
+  fnTracks++;
+}
+
+/*
+ * Sort the tracks such that the track with larger pT is always first. Tracks with equal pT are ordered by
+ * eta, phi and efficiency, in the same way as sorting tuples of these values in decreasing order.
+ *
+ * The order is found with a least significant digit radix sort. For positive floating point numbers, the
+ * bit patterns are ordered in the same way as the numbers themselves. The transformation below extends this
+ * to negative numbers, and the bits are inverted to get a decreasing order.
+ */
+void SelectedTrackBuffer::SortByPt(){
+
+  fSortIndex.resize(fnTracks);
+  fSortIndexBuffer.resize(fnTracks);
+  fSortKey.resize(fnTracks);
+  fSortKeyBuffer.resize(fnTracks);
+
+  // Find the sorting keys from the pT values
+  UInt_t bits;
+  for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+    std::memcpy(&bits, &fPt[iTrack], sizeof(UInt_t));
+    fSortKey[iTrack] = ~(bits ^ ((bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u));
+    fSortIndex[iTrack] = iTrack;
+  }
+
+  // Each pass orders the tracks stably by one digit of the key, starting from the least significant one
+  const UInt_t digitMask = (1u << fnRadixBits) - 1;
+  Int_t position, count;
+  for(Int_t iPass = 0; iPass < fnRadixPasses; iPass++){
+    const Int_t shift = iPass * fnRadixBits;
+
+    std::fill(fRadixCount.begin(), fRadixCount.end(), 0);
+    for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+      fRadixCount[(fSortKey[iTrack] >> shift) & digitMask]++;
+    }
+
+    // If all the tracks have the same digit, this pass would not change the order
+    if(fnTracks == 0 || fRadixCount[(fSortKey[0] >> shift) & digitMask] == fnTracks) continue;
+
+    // Transform the counts to the first positions of each digit value
+    position = 0;
+    for(Int_t iDigit = 0; iDigit <= (Int_t)digitMask; iDigit++){
+      count = fRadixCount[iDigit];
+      fRadixCount[iDigit] = position;
+      position += count;
+    }
+
+    for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+      position = fRadixCount[(fSortKey[iTrack] >> shift) & digitMask]++;
+      fSortKeyBuffer[position] = fSortKey[iTrack];
+      fSortIndexBuffer[position] = fSortIndex[iTrack];
+    }
+    fSortKey.swap(fSortKeyBuffer);
+    fSortIndex.swap(fSortIndexBuffer);
+  }
+
+  // Tracks with exactly the same pT are rare, so the remaining comparisons are cheap
+  SortTiedTracks();
+
+  // Reorder the columns one by one through the scratch array
+  Float_t *columns[4] = {fPt, fEta, fPhi, fEfficiency};
+  for(Float_t *column : columns){
+    for(Int_t iTrack = 0; iTrack < fnTracks; iTrack++){
+      fSortBuffer[iTrack] = column[fSortIndex[iTrack]];
+    }
+    std::copy(fSortBuffer, fSortBuffer + fnTracks, column);
+  }
+}
+
+/*
+ * Order the tracks with equal pT by eta, phi and efficiency in decreasing order. The tracks must be already
+ * sorted by pT in fSortIndex, with the matching keys in fSortKey.
+ */
+void SelectedTrackBuffer::SortTiedTracks(){
+  Int_t lastTied;
+  for(Int_t firstTied = 0; firstTied < fnTracks; firstTied = lastTied){
+    lastTied = firstTied + 1;
+    while(lastTied < fnTracks && fSortKey[lastTied] == fSortKey[firstTied]) lastTied++;
+    if(lastTied - firstTied < 2) continue;
+
+    std::sort(fSortIndex.begin() + firstTied, fSortIndex.begin() + lastTied, [this](const Int_t first, const Int_t second){
+      if(fEta[first] != fEta[second]) return fEta[first] > fEta[second];
+      if(fPhi[first] != fPhi[second]) return fPhi[first] > fPhi[second];
+      return fEfficiency[first] > fEfficiency[second];
+    });
+  }
+}
+
+// Getter for the number of tracks in the buffer
+Int_t SelectedTrackBuffer::GetNTracks() const{
+  return fnTracks;
+}
+
+// Getter for the track pT array
+const Float_t* SelectedTrackBuffer::GetPtArray() const{
+  return fPt;
+}
+
+// Getter for the track eta array
+const Float_t* SelectedTrackBuffer::GetEtaArray() const{
+  return fEta;
+}
+
+// Getter for the track phi array
+const Float_t* SelectedTrackBuffer::GetPhiArray() const{
+  return fPhi;
+}
+
+// Getter for the track efficiency array
+const Float_t* SelectedTrackBuffer::GetEfficiencyArray() const{
+  return fEfficiency;
+}
+
+/*
+ * Make sure that the buffers can hold the given number of tracks. The buffers are never shrunk.
+ *
+ *  Arguments:
+ *   const Int_t nTracks = Number of tracks that need to fit to the buffers
+ */
+void SelectedTrackBuffer::Reserve(const Int_t nTracks){
+  if(nTracks <= fCapacity) return;
+
+  // Grow at least by a factor two, such that adding tracks one by one does not reallocate too often
+  Int_t capacity = std::max(nTracks, 2*fCapacity);
+  capacity = ((capacity + fBufferGranularity - 1) / fBufferGranularity) * fBufferGranularity;
+  Allocate(capacity);
+}
+
+/*
+ * Replace the buffers with buffers of the given size. The tracks in the buffer are kept.
+ *
+ *  Arguments:
+ *   const Int_t capacity = Number of tracks that fit to the new buffers
+ */
+void SelectedTrackBuffer::Allocate(const Int_t capacity){
+
+  Float_t **columns[5] = {&fPt, &fEta, &fPhi, &fEfficiency, &fSortBuffer};
+  Float_t *newColumn;
+  for(Float_t **column : columns){
+    newColumn = AllocateArray(capacity);
+    if(*column) std::copy(*column, *column + fnTracks, newColumn);
+    std::free(*column);
+    *column = newColumn;
+  }
+
+  fCapacity = capacity;
+}
+
+/*
+ * Allocate one aligned array
+ *
+ *  Arguments:
+ *   const Int_t capacity = Number of elements in the array
+ *
+ *   return: Pointer to the array. Must be released with std::free.
+ */
+Float_t* SelectedTrackBuffer::AllocateArray(const Int_t capacity){
+
+  // The size of an aligned allocation must be a multiple of the alignment
+  size_t arraySize = std::max(capacity, 1) * sizeof(Float_t);
+  arraySize = ((arraySize + fAlignment - 1) / fAlignment) * fAlignment;
+
+  Float_t *array = static_cast<Float_t*>(std::aligned_alloc(fAlignment, arraySize));
+  if(array == NULL){
+    cout << "Error! Could not allocate the selected track buffer for " << capacity << " tracks" << endl;
+    assert(0);
+  }
+  return array;
+}
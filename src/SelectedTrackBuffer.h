@@ -0,0 +1,86 @@
+// Buffer for the tracks selected for the track pairing
+//
+//===========================================================
+// SelectedTrackBuffer.h
+//
+// The pT, eta, phi and efficiency of the selected tracks are stored in separate aligned arrays, such that
+// the pair loops can go through them without bounds checks and the compiler can vectorize the loops over
+// one component. The buffer grows to the largest number of tracks seen and is reused for all the events.
+// The tracks are ordered in pT with a radix sort on the bit pattern of the pT values, such that the sorting
+// time grows only linearly with the number of tracks.
+//===========================================================
+
+#ifndef SELECTEDTRACKBUFFER_H
+#define SELECTEDTRACKBUFFER_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <assert.h>
+
+// Root includes
+#include <Rtypes.h>
+
+using namespace std;
+
+class SelectedTrackBuffer{
+
+private:
+  static const Int_t fAlignment = 32;          // Alignment of the arrays in bytes
+  static const Int_t fBufferGranularity = 64;  // Buffer sizes are rounded up to a multiple of this
+  static const Int_t fnInitialTracks = 2048;   // Initial size of the buffers
+  static const Int_t fnRadixBits = 11;         // Number of key bits sorted in one radix sort pass
+  static const Int_t fnRadixPasses = 3;        // Number of radix sort passes needed for 32 bit keys
+
+public:
+
+  // Constructors and destructor
+  SelectedTrackBuffer();                                        // Default constructor
+  SelectedTrackBuffer(const SelectedTrackBuffer& in);           // Copy constructor
+  ~SelectedTrackBuffer();                                       // Destructor
+  SelectedTrackBuffer& operator=(const SelectedTrackBuffer& obj); // Equal sign operator
+
+  // Methods
+  void Clear();                    // Remove all the tracks from the buffer. The memory is kept.
+  void AddTrack(const Float_t pt, const Float_t eta, const Float_t phi, const Float_t efficiency); // Add a track to the end of the buffer
+  void SortByPt();                 // Sort the tracks such that the track with larger pT is always first
+  Int_t GetNTracks() const;        // Getter for the number of tracks in the buffer
+
+  // Getters for the arrays of all the tracks
+  const Float_t* GetPtArray() const;         // Getter for the track pT array
+  const Float_t* GetEtaArray() const;        // Getter for the track eta array
+  const Float_t* GetPhiArray() const;        // Getter for the track phi array
+  const Float_t* GetEfficiencyArray() const; // Getter for the track efficiency array
+
+  // Getters for single tracks. Defined here, since these are called in the innermost pair loops.
+  Float_t GetPt(const Int_t iTrack) const{return fPt[iTrack];}                 // Getter for track pT
+  Float_t GetEta(const Int_t iTrack) const{return fEta[iTrack];}               // Getter for track eta
+  Float_t GetPhi(const Int_t iTrack) const{return fPhi[iTrack];}               // Getter for track phi
+  Float_t GetEfficiency(const Int_t iTrack) const{return fEfficiency[iTrack];} // Getter for track efficiency
+
+private:
+
+  void Reserve(const Int_t nTracks);           // Make sure that the buffers can hold the given number of tracks
+  void Allocate(const Int_t capacity);         // Replace the buffers with buffers of the given size. The content is kept.
+  static Float_t* AllocateArray(const Int_t capacity); // Allocate one aligned array
+  void SortTiedTracks();                       // Order the tracks with equal pT by eta, phi and efficiency
+
+  Int_t fnTracks;              // Number of tracks in the buffer
+  Int_t fCapacity;             // Number of tracks that fit to the buffers
+  Float_t *fPt;                // Track pT
+  Float_t *fEta;               // Track eta
+  Float_t *fPhi;               // Track phi
+  Float_t *fEfficiency;        // Track efficiency correction
+  Float_t *fSortBuffer;        // Scratch array for ordering the columns when sorting
+  std::vector<Int_t> fSortIndex; // Order of the tracks after sorting
+  std::vector<Int_t> fSortIndexBuffer; // Scratch array for the track order between radix sort passes
+  std::vector<UInt_t> fSortKey;        // Radix sort keys of the tracks in the current order
+  std::vector<UInt_t> fSortKeyBuffer;  // Scratch array for the keys between radix sort passes
+  std::vector<Int_t> fRadixCount;      // Number of keys with each digit value in the current pass
+
+};
+
+#endif
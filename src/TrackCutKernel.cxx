@@ -0,0 +1,204 @@
+// Implementation of the kernel applying the track cuts
+
+// Own includes
+#include "TrackCutKernel.h"
+
+/*
+ * Default constructor
+ */
+TrackCutKernel::TrackCutKernel() :
+  fMinPtCut(0),
+  fMaxPtCut(0),
+  fEtaCut(0),
+  fMaxPtRelativeError(0),
+  fMaxDistanceToVertex(0),
+  fCalorimeterSignalLimitPt(0),
+  fHighPtEtFraction(0),
+  fChi2QualityCut(0),
+  fMinimumTrackHits(0),
+  fCutMask()
+{
+  // Default constructor
+  for(Int_t iCut = 0; iCut < TrackPairEfficiencyHistograms::knTrackCuts; iCut++){
+    fnPassed[iCut] = 0;
+  }
+}
+
+/*
+ * Copy constructor
+ */
+TrackCutKernel::TrackCutKernel(const TrackCutKernel& in) :
+  fMinPtCut(in.fMinPtCut),
+  fMaxPtCut(in.fMaxPtCut),
+  fEtaCut(in.fEtaCut),
+  fMaxPtRelativeError(in.fMaxPtRelativeError),
+  fMaxDistanceToVertex(in.fMaxDistanceToVertex),
+  fCalorimeterSignalLimitPt(in.fCalorimeterSignalLimitPt),
+  fHighPtEtFraction(in.fHighPtEtFraction),
+  fChi2QualityCut(in.fChi2QualityCut),
+  fMinimumTrackHits(in.fMinimumTrackHits),
+  fCutMask(in.fCutMask)
+{
+  // Copy constructor
+  for(Int_t iCut = 0; iCut < TrackPairEfficiencyHistograms::knTrackCuts; iCut++){
+    fnPassed[iCut] = in.fnPassed[iCut];
+  }
+}
+
+/*
+ * Destructor
+ */
+TrackCutKernel::~TrackCutKernel(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+TrackCutKernel& TrackCutKernel::operator=(const TrackCutKernel& in){
+  if(&in == this) return *this;
+
+  fMinPtCut = in.fMinPtCut;
+  fMaxPtCut = in.fMaxPtCut;
+  fEtaCut = in.fEtaCut;
+  fMaxPtRelativeError = in.fMaxPtRelativeError;
+  fMaxDistanceToVertex = in.fMaxDistanceToVertex;
+  fCalorimeterSignalLimitPt = in.fCalorimeterSignalLimitPt;
+  fHighPtEtFraction = in.fHighPtEtFraction;
+  fChi2QualityCut = in.fChi2QualityCut;
+  fMinimumTrackHits = in.fMinimumTrackHits;
+  fCutMask = in.fCutMask;
+  for(Int_t iCut = 0; iCut < TrackPairEfficiencyHistograms::knTrackCuts; iCut++){
+    fnPassed[iCut] = in.fnPassed[iCut];
+  }
+
+  return *this;
+}
+
+/*
+ * Setter for the track pT range
+ *
+ *  Arguments:
+ *   const Double_t minPt = Tracks need to have pT above this
+ *   const Double_t maxPt = Tracks need to have pT below this
+ */
+void TrackCutKernel::SetPtCuts(const Double_t minPt, const Double_t maxPt){
+  fMinPtCut = minPt;
+  fMaxPtCut = maxPt;
+}
+
+// Setter for the maximum absolute track eta
+void TrackCutKernel::SetEtaCut(const Double_t etaCut){
+  fEtaCut = etaCut;
+}
+
+// Setter for the maximum relative pT error
+void TrackCutKernel::SetMaxPtRelativeError(const Double_t maxError){
+  fMaxPtRelativeError = maxError;
+}
+
+// Setter for the maximum significance of the distance to the primary vertex
+void TrackCutKernel::SetMaxDistanceToVertex(const Double_t maxDistance){
+  fMaxDistanceToVertex = maxDistance;
+}
+
+/*
+ * Setter for the calorimeter signal requirement for high pT tracks
+ *
+ *  Arguments:
+ *   const Double_t limitPt = Require signal in calorimeters for track above this pT
+ *   const Double_t etFraction = Minimum required Et as a fraction of track pT
+ */
+void TrackCutKernel::SetCalorimeterSignalCut(const Double_t limitPt, const Double_t etFraction){
+  fCalorimeterSignalLimitPt = limitPt;
+  fHighPtEtFraction = etFraction;
+}
+
+/*
+ * Setter for the reconstruction quality cuts
+ *
+ *  Arguments:
+ *   const Double_t chi2Cut = Maximum normalized chi2 per tracker layer hit
+ *   const Double_t minimumHits = Minimum number of hits for the track
+ */
+void TrackCutKernel::SetReconstructionQualityCuts(const Double_t chi2Cut, const Double_t minimumHits){
+  fChi2QualityCut = chi2Cut;
+  fMinimumTrackHits = minimumHits;
+}
+
+/*
+ * Evaluate the cuts for all the tracks in the event and count the tracks passing each step
+ *
+ *  Arguments:
+ *   const ForestReader *eventReader = Reader from which the track columns of the event are read
+ */
+void TrackCutKernel::SelectTracks(const ForestReader *eventReader){
+
+  const ForestReader::EventView &eventView = eventReader->GetEventView(fCutColumns);
+  const Int_t nTracks = eventView.fnTracks;
+  fCutMask.resize(nTracks);
+
+  // Evaluate all the cuts without branches. The calorimeter signal is only checked here for low pT tracks.
+  // The cuts are written as negations of the failing conditions, such that tracks with undefined values
+  // are treated in the same way as in the track by track cuts.
+  Double_t trackPt, trackEta;
+  Float_t distanceZ, distanceXY;
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    trackPt = eventView.fTrackPt[iTrack];
+    trackEta = eventView.fTrackEta[iTrack];
+    distanceZ = eventView.fTrackVertexDistanceZ[iTrack]/eventView.fTrackVertexDistanceZError[iTrack];
+    distanceXY = eventView.fTrackVertexDistanceXY[iTrack]/eventView.fTrackVertexDistanceXYError[iTrack];
+
+    fCutMask[iTrack] = (1 << TrackPairEfficiencyHistograms::kAllTracks)
+      | ((!(trackPt <= fMinPtCut) & !(trackPt >= fMaxPtCut)) << TrackPairEfficiencyHistograms::kPtCuts)
+      | (!(TMath::Abs(trackEta) >= fEtaCut) << TrackPairEfficiencyHistograms::kEtaCut)
+      | ((eventView.fTrackHighPurity[iTrack] != 0) << TrackPairEfficiencyHistograms::kHighPurity)
+      | (!(eventView.fTrackPtError[iTrack]/trackPt >= fMaxPtRelativeError) << TrackPairEfficiencyHistograms::kPtError)
+      | ((!(TMath::Abs(distanceZ) >= fMaxDistanceToVertex) & !(TMath::Abs(distanceXY) >= fMaxDistanceToVertex)) << TrackPairEfficiencyHistograms::kVertexDistance)
+      | ((trackPt < fCalorimeterSignalLimitPt) << TrackPairEfficiencyHistograms::kCaloSignal)
+      | ((!(eventView.fTrackNormalizedChi2[iTrack] / (1.0*eventView.fTrackHitsTrackerLayer[iTrack]) >= fChi2QualityCut) & !(eventView.fTrackHits[iTrack] < fMinimumTrackHits)) << TrackPairEfficiencyHistograms::kReconstructionQuality);
+  }
+
+  // The transverse energy in calorimeters is only needed for the few high pT tracks passing all the previous cuts.
+  // For other tracks an earlier failed cut decides both the counts and the selection. The calorimeter energy
+  // columns are only read if there is a track needing them in the event.
+  const UChar_t caloSignalCheckMask = fCaloSignalNeededMask | (1 << TrackPairEfficiencyHistograms::kCaloSignal);
+  Bool_t caloSignalNeeded = false;
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    caloSignalNeeded |= ((fCutMask[iTrack] & caloSignalCheckMask) == fCaloSignalNeededMask);
+  }
+  if(caloSignalNeeded) eventReader->GetEventView(fCaloSignalColumns);
+
+  Double_t trackEt;
+  for(Int_t iTrack = 0; iTrack < nTracks && caloSignalNeeded; iTrack++){
+    if((fCutMask[iTrack] & caloSignalCheckMask) != fCaloSignalNeededMask) continue;
+    trackPt = eventView.fTrackPt[iTrack];
+    trackEt = (eventView.fTrackEnergyEcal[iTrack]+eventView.fTrackEnergyHcal[iTrack])/TMath::CosH(eventView.fTrackEta[iTrack]);
+    fCutMask[iTrack] |= (trackEt >= fHighPtEtFraction*trackPt) << TrackPairEfficiencyHistograms::kCaloSignal;
+  }
+
+  // A track survives all the cuts up to the first failed one. Count the tracks by the first failed cut.
+  Int_t nFirstFailed[TrackPairEfficiencyHistograms::knTrackCuts+1] = {0};
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    nFirstFailed[__builtin_ctz(~(UInt_t)fCutMask[iTrack])]++;
+  }
+
+  // The number of tracks passing a step is the number of tracks failing only at a later step
+  Int_t nPassed = 0;
+  for(Int_t iCut = TrackPairEfficiencyHistograms::knTrackCuts-1; iCut >= 0; iCut--){
+    nPassed += nFirstFailed[iCut+1];
+    fnPassed[iCut] = nPassed;
+  }
+}
+
+/*
+ * Getter for the number of tracks passing all the cuts up to the given one in the last event
+ *
+ *  Arguments:
+ *   const Int_t iCut = Index of the cut in enumTrackCuts
+ *
+ *   return: Number of tracks passing the cuts up to iCut
+ */
+Int_t TrackCutKernel::GetNPassed(const Int_t iCut) const{
+  return fnPassed[iCut];
+}
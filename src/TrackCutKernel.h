@@ -0,0 +1,79 @@
+// Kernel for applying the track cuts to all the tracks of an event at once
+//
+//===========================================================
+// TrackCutKernel.h
+//
+// All the track cuts are evaluated over the track columns of the event view in loops without branches, such
+// that the compiler can vectorize them. Only the columns used by the cuts are asked from the reader, and the
+// calorimeter energy columns only for events with tracks above the calorimeter signal limit. The result is a
+// bitmask for each track, where the bit for each cut in enumTrackCuts is set if the track passes that cut.
+// The number of tracks surviving all the cuts up to each step is counted for the event, such that the track
+// cut histogram can be filled once per event. The comparisons are done with the same precision as in the per
+// track cut function used before.
+//===========================================================
+
+#ifndef TRACKCUTKERNEL_H
+#define TRACKCUTKERNEL_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+
+// Root includes
+#include <TMath.h>
+
+// Own includes
+#include "ForestReader.h"
+#include "TrackPairEfficiencyHistograms.h"
+
+using namespace std;
+
+class TrackCutKernel{
+
+public:
+
+  // Constructors and destructor
+  TrackCutKernel();                                   // Default constructor
+  TrackCutKernel(const TrackCutKernel& in);           // Copy constructor
+  ~TrackCutKernel();                                  // Destructor
+  TrackCutKernel& operator=(const TrackCutKernel& obj); // Equal sign operator
+
+  // Setters
+  void SetPtCuts(const Double_t minPt, const Double_t maxPt);  // Setter for the track pT range
+  void SetEtaCut(const Double_t etaCut);                       // Setter for the maximum absolute track eta
+  void SetMaxPtRelativeError(const Double_t maxError);         // Setter for the maximum relative pT error
+  void SetMaxDistanceToVertex(const Double_t maxDistance);     // Setter for the maximum significance of the distance to the primary vertex
+  void SetCalorimeterSignalCut(const Double_t limitPt, const Double_t etFraction); // Setter for the calorimeter signal requirement for high pT tracks
+  void SetReconstructionQualityCuts(const Double_t chi2Cut, const Double_t minimumHits); // Setter for the reconstruction quality cuts
+
+  // Methods
+  void SelectTracks(const ForestReader *eventReader); // Evaluate the cuts for all the tracks in the event
+  Int_t GetNPassed(const Int_t iCut) const;     // Getter for the number of tracks passing all the cuts up to the given one
+
+  // Getter for the selection of a single track. Defined here, since this is called in the track loop.
+  Bool_t PassesCuts(const Int_t iTrack) const{return fCutMask[iTrack] == fAllCutsMask;}
+
+private:
+
+  static const UChar_t fAllCutsMask = (1 << TrackPairEfficiencyHistograms::knTrackCuts) - 1; // Bitmask for a track passing all the cuts
+  static const UChar_t fCaloSignalNeededMask = (1 << TrackPairEfficiencyHistograms::kCaloSignal) - 1; // Bitmask for a track reaching the calorimeter signal cut
+  
+  // Track columns read for the cuts. The calorimeter energies are read separately, since only high pT tracks need them.
+  static const Int_t fCutColumns = (1 << ForestReader::kTrackPtColumn) | (1 << ForestReader::kTrackPtErrorColumn) | (1 << ForestReader::kTrackEtaColumn) | (1 << ForestReader::kHighPurityColumn) | (1 << ForestReader::kVertexDistanceZColumn) | (1 << ForestReader::kVertexDistanceZErrorColumn) | (1 << ForestReader::kVertexDistanceXYColumn) | (1 << ForestReader::kVertexDistanceXYErrorColumn) | (1 << ForestReader::kChi2Column) | (1 << ForestReader::kHitsTrackerLayerColumn) | (1 << ForestReader::kHitsTrackColumn);
+  static const Int_t fCaloSignalColumns = (1 << ForestReader::kEnergyEcalColumn) | (1 << ForestReader::kEnergyHcalColumn);
+
+  Double_t fMinPtCut;                   // Minimum track pT
+  Double_t fMaxPtCut;                   // Maximum track pT
+  Double_t fEtaCut;                     // Maximum absolute track eta
+  Double_t fMaxPtRelativeError;         // Maximum relative error for track pT
+  Double_t fMaxDistanceToVertex;        // Maximum distance to the primary vertex in units of its error
+  Double_t fCalorimeterSignalLimitPt;   // Require signal in calorimeters for track above this pT
+  Double_t fHighPtEtFraction;           // For high pT tracks, minimum required Et as a fraction of track pT
+  Double_t fChi2QualityCut;             // Maximum chi2 per tracker layer hit
+  Double_t fMinimumTrackHits;           // Minimum number of hits for the track
+  std::vector<UChar_t> fCutMask;        // Bitmask of the passed cuts for each track
+  Int_t fnPassed[TrackPairEfficiencyHistograms::knTrackCuts]; // Number of tracks passing all the cuts up to each step
+
+};
+
+#endif
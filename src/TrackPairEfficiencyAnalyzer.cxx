@@ -25,6 +25,11 @@ TrackPairEfficiencyAnalyzer::TrackPairEfficiencyAnalyzer() :
   fJetType(0),
   fUseTrigger(false),
   fDebugLevel(0),
+  fReadTrackColumnsOnDemand(false),
+  fTreeCacheSize(0),
+  fAsyncPrefetch(false),
+  fUseEventIndex(false),
+  fNumberOfThreads(1),
   fVzWeight(1),
   fCentralityWeight(1),
   fPtHatWeight(1),
@@ -50,12 +55,34 @@ TrackPairEfficiencyAnalyzer::TrackPairEfficiencyAnalyzer() :
   fHighPtEtFraction(0),
   fChi2QualityCut(0),
   fMinimumTrackHits(0),
-  fSubeventCut(0)
+  fSubeventCut(0),
+  fTrackCutKernel(),
+  fSelectedTracks(),
+  fSelectedParticles(),
+  fJetConeIndices(),
+  fTrackConeGrid(0.4),
+  fParticleConeGrid(0.4),
+  fTrackPairEngine(0.8),
+  fTrackPairSink(),
+  fGenParticlePairSink(),
+  fTrackPairCloseToJetSink(),
+  fGenParticlePairCloseToJetSink()
 {
   // Default constructor
   fHistograms = new TrackPairEfficiencyHistograms();
   fHistograms->CreateHistograms();
   
+  // Connect the pair fillers to the pair histograms
+  if(fHistograms->fhTrackPairs){
+    fTrackPairSink.SetHistogram(fHistograms->fhTrackPairs);
+    fGenParticlePairSink.SetHistogram(fHistograms->fhGenParticlePairs);
+  } else {
+    fTrackPairSink.SetHistogram(fHistograms->fhTrackPairSlices);
+    fGenParticlePairSink.SetHistogram(fHistograms->fhGenParticlePairSlices);
+  }
+  fTrackPairCloseToJetSink.SetHistogram(fHistograms->fhTrackPairsCloseToJet);
+  fGenParticlePairCloseToJetSink.SetHistogram(fHistograms->fhGenParticlePairsCloseToJet);
+  
   // Initialize readers to null
   fEventReader = NULL;
   
@@ -71,12 +98,33 @@ TrackPairEfficiencyAnalyzer::TrackPairEfficiencyAnalyzer(std::vector<TString> fi
   fVzWeight(1),
   fCentralityWeight(1),
   fPtHatWeight(1),
-  fTotalEventWeight(1)
+  fTotalEventWeight(1),
+  fSelectedTracks(),
+  fSelectedParticles(),
+  fJetConeIndices(),
+  fTrackConeGrid(0.4),
+  fParticleConeGrid(0.4),
+  fTrackPairEngine(0.8),
+  fTrackPairSink(),
+  fGenParticlePairSink(),
+  fTrackPairCloseToJetSink(),
+  fGenParticlePairCloseToJetSink()
 {
   // Custom constructor
   fHistograms = new TrackPairEfficiencyHistograms(fCard);
   fHistograms->CreateHistograms();
   
+  // Connect the pair fillers to the pair histograms
+  if(fHistograms->fhTrackPairs){
+    fTrackPairSink.SetHistogram(fHistograms->fhTrackPairs);
+    fGenParticlePairSink.SetHistogram(fHistograms->fhGenParticlePairs);
+  } else {
+    fTrackPairSink.SetHistogram(fHistograms->fhTrackPairSlices);
+    fGenParticlePairSink.SetHistogram(fHistograms->fhGenParticlePairSlices);
+  }
+  fTrackPairCloseToJetSink.SetHistogram(fHistograms->fhTrackPairsCloseToJet);
+  fGenParticlePairCloseToJetSink.SetHistogram(fHistograms->fhGenParticlePairsCloseToJet);
+  
   // Initialize readers to null
   fEventReader = NULL;
   
@@ -144,6 +192,11 @@ TrackPairEfficiencyAnalyzer::TrackPairEfficiencyAnalyzer(const TrackPairEfficien
   fJetType(in.fJetType),
   fUseTrigger(in.fUseTrigger),
   fDebugLevel(in.fDebugLevel),
+  fReadTrackColumnsOnDemand(in.fReadTrackColumnsOnDemand),
+  fTreeCacheSize(in.fTreeCacheSize),
+  fAsyncPrefetch(in.fAsyncPrefetch),
+  fUseEventIndex(in.fUseEventIndex),
+  fNumberOfThreads(in.fNumberOfThreads),
   fVzWeight(in.fVzWeight),
   fCentralityWeight(in.fCentralityWeight),
   fPtHatWeight(in.fPtHatWeight),
@@ -169,7 +222,18 @@ TrackPairEfficiencyAnalyzer::TrackPairEfficiencyAnalyzer(const TrackPairEfficien
   fHighPtEtFraction(in.fHighPtEtFraction),
   fChi2QualityCut(in.fChi2QualityCut),
   fMinimumTrackHits(in.fMinimumTrackHits),
-  fSubeventCut(in.fSubeventCut)
+  fSubeventCut(in.fSubeventCut),
+  fTrackCutKernel(in.fTrackCutKernel),
+  fSelectedTracks(in.fSelectedTracks),
+  fSelectedParticles(in.fSelectedParticles),
+  fJetConeIndices(in.fJetConeIndices),
+  fTrackConeGrid(in.fTrackConeGrid),
+  fParticleConeGrid(in.fParticleConeGrid),
+  fTrackPairEngine(in.fTrackPairEngine),
+  fTrackPairSink(in.fTrackPairSink),
+  fGenParticlePairSink(in.fGenParticlePairSink),
+  fTrackPairCloseToJetSink(in.fTrackPairCloseToJetSink),
+  fGenParticlePairCloseToJetSink(in.fGenParticlePairCloseToJetSink)
 {
   // Copy constructor
   
@@ -195,6 +259,11 @@ TrackPairEfficiencyAnalyzer& TrackPairEfficiencyAnalyzer::operator=(const TrackP
   fJetType = in.fJetType;
   fUseTrigger = in.fUseTrigger;
   fDebugLevel = in.fDebugLevel;
+  fReadTrackColumnsOnDemand = in.fReadTrackColumnsOnDemand;
+  fTreeCacheSize = in.fTreeCacheSize;
+  fAsyncPrefetch = in.fAsyncPrefetch;
+  fUseEventIndex = in.fUseEventIndex;
+  fNumberOfThreads = in.fNumberOfThreads;
   fVzWeight = in.fVzWeight;
   fCentralityWeight = in.fCentralityWeight;
   fPtHatWeight = in.fPtHatWeight;
@@ -221,6 +290,17 @@ TrackPairEfficiencyAnalyzer& TrackPairEfficiencyAnalyzer::operator=(const TrackP
   fChi2QualityCut = in.fChi2QualityCut;
   fMinimumTrackHits = in.fMinimumTrackHits;
   fSubeventCut = in.fSubeventCut;
+  fTrackCutKernel = in.fTrackCutKernel;
+  fSelectedTracks = in.fSelectedTracks;
+  fSelectedParticles = in.fSelectedParticles;
+  fJetConeIndices = in.fJetConeIndices;
+  fTrackConeGrid = in.fTrackConeGrid;
+  fParticleConeGrid = in.fParticleConeGrid;
+  fTrackPairEngine = in.fTrackPairEngine;
+  fTrackPairSink = in.fTrackPairSink;
+  fGenParticlePairSink = in.fGenParticlePairSink;
+  fTrackPairCloseToJetSink = in.fTrackPairCloseToJetSink;
+  fGenParticlePairCloseToJetSink = in.fGenParticlePairCloseToJetSink;
   
   return *this;
 }
@@ -297,6 +377,15 @@ void TrackPairEfficiencyAnalyzer::ReadConfigurationFromCard(){
   //              Debug messages
   //************************************************
   fDebugLevel = fCard->Get("DebugLevel");
+  
+  //************************************************
+  //              Forest reading
+  //************************************************
+  fReadTrackColumnsOnDemand = (fCard->Get("ReadTrackColumnsOnDemand") == 1); // Read track branches only when they are needed
+  fTreeCacheSize = fCard->Get("TreeCacheSize");           // Total read cache budget for the forest trees in MB
+  fAsyncPrefetch = (fCard->Get("AsyncPrefetch") == 1);    // Prefetch the next cluster asynchronously to the read cache
+  fUseEventIndex = (fCard->Get("UseEventIndex") == 1);    // Apply the event cuts from the event selection index
+  fNumberOfThreads = fCard->Get("NumberOfThreads");       // Number of threads for decompressing the forest baskets
 }
 
 /*
@@ -313,6 +402,8 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
   
   // Event variables
   Int_t nEvents = 0;                // Number of events
+  Int_t iEvent = 0;                 // Index of the analyzed event in the forest
+  TEntryList *selectedEvents;       // Events passing the event cuts according to the event selection index
   Double_t vz = 0;                  // Vertex z-position
   Double_t centrality = 0;          // Event centrality
   Int_t hiBin = 0;                  // CMS hiBin (centrality * 2)
@@ -320,19 +411,12 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
   
   // Variables for tracks
   Double_t fillerTrack[4];          // Track histogram filler
-  Double_t fillerTrackPair[6];      // Track pair histogram filler
   Int_t nTracks;                    // Number of tracks in an event
   Double_t trackPt;                 // Track pT
   Double_t trackEta;                // Track eta
   Double_t trackPhi;                // Track phi
   Double_t trackEfficiency;         // Track efficiency
-  Double_t averagePairEta = 0;      // Average eta of the track pair
-  Double_t averagePairPhi = 0;      // Average phi of the track pair
-  Double_t pairDeltaR = 0;          // DeltaR between the two tracks in a pair
   
-  // Vectors of tuples to make the track pairing faster
-  vector<std::tuple<double,double,double,double>> selectedTrackInformation;  // Track pT, eta, phi and efficiency for tracks passing the cuts
-
   // Variables for jets
   Int_t nJets = 0;                  // Number of jets in an event
   Double_t jetPt = 0;               // pT of the i:th jet in the event
@@ -353,6 +437,24 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
   //************************************************
   
   fEventReader = new ForestReader(fDataType, fJetType, fJetAxis, fUseTrigger);
+  fEventReader->SetReadTrackColumnsOnDemand(fReadTrackColumnsOnDemand);
+  fEventReader->SetTreeCacheSize((Long64_t)(fTreeCacheSize*1024*1024));
+  fEventReader->SetAsyncPrefetching(fAsyncPrefetch);
+  fEventReader->SetNumberOfThreads(fNumberOfThreads);
+  
+  // The track cuts are evaluated for all the tracks of an event at once
+  fTrackCutKernel.SetPtCuts(fTrackMinPtCut, fTrackMaxPtCut);
+  fTrackCutKernel.SetEtaCut(fTrackEtaCut);
+  fTrackCutKernel.SetMaxPtRelativeError(fMaxTrackPtRelativeError);
+  fTrackCutKernel.SetMaxDistanceToVertex(fMaxTrackDistanceToVertex);
+  fTrackCutKernel.SetCalorimeterSignalCut(fCalorimeterSignalLimitPt, fHighPtEtFraction);
+  fTrackCutKernel.SetReconstructionQualityCuts(fChi2QualityCut, fMinimumTrackHits);
+  
+  // The trigger cuts are evaluated once per event in the pair enumeration
+  fTrackPairEngine.SetTriggerCuts(fTriggerEtaCut, fCutBadPhiRegionTrigger);
+  
+  // Tell which instruction set is used to find the track pairs
+  if(fDebugLevel > 0) cout << "Track pairs are preselected with the " << fTrackPairEngine.GetImplementationName() << " kernel" << endl;
   
   
   //************************************************
@@ -369,24 +471,30 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
     
     // Find the filename and open the input file
     currentFile = fFileNames.at(iFile);
-    inputFile = TFile::Open(currentFile);
     
-    // Check that the file exists
-    if(!inputFile){
-      cout << "Error! Could not find the file: " << currentFile.Data() << endl;
-      assert(0);
-    }
-
-    // Check that the file is open
-    if(!inputFile->IsOpen()){
-      cout << "Error! Could not open the file: " << currentFile.Data() << endl;
-      assert(0);
-    }
-    
-    // Check that the file is not zombie
-    if(inputFile->IsZombie()){
-      cout << "Error! The following file is a zombie: " << currentFile.Data() << endl;
-      assert(0);
+    // Mapped forest files are not ROOT files. They are mapped to memory directly by the reader.
+    if(MappedForestFile::IsMappedForestFile(currentFile)){
+      inputFile = NULL;
+    } else {
+      inputFile = TFile::Open(currentFile);
+      
+      // Check that the file exists
+      if(!inputFile){
+        cout << "Error! Could not find the file: " << currentFile.Data() << endl;
+        assert(0);
+      }
+      
+      // Check that the file is open
+      if(!inputFile->IsOpen()){
+        cout << "Error! Could not open the file: " << currentFile.Data() << endl;
+        assert(0);
+      }
+      
+      // Check that the file is not zombie
+      if(inputFile->IsZombie()){
+        cout << "Error! The following file is a zombie: " << currentFile.Data() << endl;
+        assert(0);
+      }
     }
     
 
@@ -394,29 +502,45 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
     if(fDebugLevel > 0) cout << "Reading from file: " << currentFile.Data() << endl;
 
     
+    //************************************************
+    //     Select the events from the event index
+    //************************************************
+    
+    // The event cuts are applied from the index, such that only the selected events are read from the forest
+    selectedEvents = NULL;
+    if(fUseEventIndex) selectedEvents = SelectEventsFromIndex(inputFile, currentFile);
+    
     //************************************************
     //            Read forest from file
     //************************************************
     
     // If file is good, read the forest from the file
-    fEventReader->ReadForestFromFile(inputFile);  // There might be a memory leak in handling the forest...
+    if(inputFile){
+      fEventReader->ReadForestFromFile(inputFile);  // There might be a memory leak in handling the forest...
+    } else {
+      fEventReader->ReadMappedForestFromFile(currentFile);
+    }
     nEvents = fEventReader->GetNEvents();
+    if(selectedEvents) nEvents = selectedEvents->GetN();
 
     //************************************************
     //         Main event loop for each file
     //************************************************
     
-    for(Int_t iEvent = 0; iEvent < nEvents; iEvent++){ // nEvents
+    for(Int_t iEntry = 0; iEntry < nEvents; iEntry++){ // nEvents
       
       //************************************************
       //         Read basic event information
       //************************************************
       
+      // Find the index of the event in the forest
+      iEvent = selectedEvents ? selectedEvents->GetEntry(iEntry) : iEntry;
+      
       // Print to console how the analysis is progressing
-      if(fDebugLevel > 1 && iEvent % 1000 == 0) cout << "Analyzing event " << iEvent << endl;
+      if(fDebugLevel > 1 && iEntry % 1000 == 0) cout << "Analyzing event " << iEvent << endl;
       
-      // Read the event to memory
-      fEventReader->GetEvent(iEvent);
+      // Read only the event level information to memory. Jets and tracks are read after the event cuts.
+      fEventReader->GetEventInformation(iEvent);
 
       // Get vz, centrality and pT hat information
       vz = fEventReader->GetVz();
@@ -434,14 +558,14 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
       fPtHatWeight = fEventReader->GetEventWeight();
       fTotalEventWeight = fVzWeight*fCentralityWeight*fPtHatWeight;
       
-      // Fill event counter histogram
-      fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kAll);          // All the events looped over
+      // Fill event counter histogram. With event index the event cuts are already counted for all events.
+      if(!selectedEvents) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kAll);          // All the events looped over
       
       //  ============================================
       //  ===== Apply all the event quality cuts =====
       //  ============================================
       
-      if(!PassEventCuts(fEventReader)) continue;
+      if(!PassEventCuts(EventSelectionIndex::ReadEventInformation(fEventReader), selectedEvents != NULL)) continue;
       
       // Fill the event information histograms for the events that pass the event cuts
       fHistograms->fhVertexZ->Fill(vz);                            // z vertex distribution from all events
@@ -451,6 +575,19 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
       fHistograms->fhPtHat->Fill(ptHat);                           // pT hat histogram
       fHistograms->fhPtHatWeighted->Fill(ptHat,fPtHatWeight);      // pT het histogram weighted with corresponding cross section and event number
       
+      // Now that the event is accepted, read the jets, tracks and particles to memory
+      fEventReader->GetEventContent();
+      
+      // Centrality and event weight are the same for all the track pairs in the event
+      fTrackPairSink.BindAxis(InclusivePairAxes::kCentrality, centrality);
+      fTrackPairSink.SetWeight(fTotalEventWeight);
+      fGenParticlePairSink.BindAxis(InclusivePairAxes::kCentrality, centrality);
+      fGenParticlePairSink.SetWeight(fTotalEventWeight);
+      fTrackPairCloseToJetSink.BindAxis(JetConePairAxes::kCentrality, centrality);
+      fTrackPairCloseToJetSink.SetWeight(fTotalEventWeight);
+      fGenParticlePairCloseToJetSink.BindAxis(JetConePairAxes::kCentrality, centrality);
+      fGenParticlePairCloseToJetSink.SetWeight(fTotalEventWeight);
+      
       // ======================================
       // ===== Event quality cuts applied =====
       // ======================================
@@ -459,22 +596,32 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
       //             Collect basic track distribution hisotgrams
       //***********************************************************************
       
-      // Clear the track information vector
-      selectedTrackInformation.clear();
+      // The tracks passing the cuts and their efficiency corrections are collected once per event to the selected
+      // track table. The same table is used for the inclusive pairs and for the pairs close to each jet.
+      
+      // Clear the selected track buffer
+      fSelectedTracks.Clear();
+      
+      // Apply the track cuts to all the tracks in the event and count how many tracks pass each cut
+      fTrackCutKernel.SelectTracks(fEventReader);
+      FillTrackCutCounts(fHistograms->fhTrackCuts);
+      
+      // After the cuts, only the kinematics of the tracks are needed
+      const ForestReader::EventView &eventView = fEventReader->GetEventView((1 << ForestReader::kTrackPtColumn) | (1 << ForestReader::kTrackPhiColumn) | (1 << ForestReader::kTrackEtaColumn));
       
       // Loop over all track in the event
-      nTracks = fEventReader->GetNTracks();
+      nTracks = eventView.fnTracks;
       for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
         
         // Check that all the track cuts are passed
-        if(!PassTrackCuts(fEventReader,iTrack,fHistograms->fhTrackCuts,false)) continue;
+        if(!fTrackCutKernel.PassesCuts(iTrack)) continue;
         
-        // Get the track information and add it to vector
-        trackPt = fEventReader->GetTrackPt(iTrack);
-        trackEta = fEventReader->GetTrackEta(iTrack);
-        trackPhi = fEventReader->GetTrackPhi(iTrack);
-        trackEfficiency = GetTrackEfficiencyCorrection(iTrack);
-        selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, trackEfficiency));
+        // Get the track information and add it to the buffer
+        trackPt = eventView.fTrackPt[iTrack];
+        trackEta = eventView.fTrackEta[iTrack];
+        trackPhi = eventView.fTrackPhi[iTrack];
+        trackEfficiency = GetTrackEfficiencyCorrection(eventView, iTrack);
+        fSelectedTracks.AddTrack(trackPt, trackEta, trackPhi, trackEfficiency);
         
         // Fill track histograms
         fillerTrack[0] = trackPt;      // Axis 0: Track pT
@@ -486,45 +633,19 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
         
       } // Track loop
       
-      // Sort the vector such that the larger track pT will always be assigned to the first slot
-      std::sort(selectedTrackInformation.begin(), selectedTrackInformation.end(), std::greater<std::tuple<double,double,double,double>>());
+      // Sort the tracks such that the larger track pT will always be assigned to the first slot
+      fSelectedTracks.SortByPt();
       
-      // Once we have looped over all the tracks, only loop over tracks that pass the cuts to construct all possible track pairings
-      for(Int_t iTrack = 0; iTrack < selectedTrackInformation.size(); iTrack++){
-        
-        // Apply extra cuts for the trigger particle in the analysis
-        if(TMath::Abs(std::get<kTrackEta>(selectedTrackInformation.at(iTrack))) > fTriggerEtaCut) continue;  // Stricter eta cut for trigger particles
-        if(fCutBadPhiRegionTrigger && (std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)) > -0.1 && std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)) < 1.2)) continue; // Do not let the trigger particle to be in the phi region with bad tracker performance
-        
-        for(Int_t jTrack = iTrack+1; jTrack < selectedTrackInformation.size(); jTrack++){
-          
-          // Calculate the distance of the two tracks from each other
-          pairDeltaR = GetDeltaR(std::get<kTrackEta>(selectedTrackInformation.at(iTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)), std::get<kTrackEta>(selectedTrackInformation.at(jTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(jTrack)));
-          
-          // Fill the track pair histograms for tracks relatively close to each other
-          if(pairDeltaR < 0.8){
-            
-            // Calculate the average pair eta and phi positions
-            averagePairEta = (std::get<kTrackEta>(selectedTrackInformation.at(iTrack))+std::get<kTrackEta>(selectedTrackInformation.at(jTrack)))/2.0;
-            averagePairPhi = GetAveragePhi(std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(jTrack)));
-            
-            fillerTrackPair[0] = pairDeltaR;                                               // Axis 0: DeltaR between the two tracks
-            fillerTrackPair[1] = std::get<kTrackPt>(selectedTrackInformation.at(iTrack));  // Axis 1: Higher track pT
-            fillerTrackPair[2] = std::get<kTrackPt>(selectedTrackInformation.at(jTrack));  // Axis 2: Lower track pT
-            fillerTrackPair[3] = averagePairPhi;                                           // Axis 3: Average pair phi
-            fillerTrackPair[4] = averagePairEta;                                           // Axis 4: Average pair eta
-            fillerTrackPair[5] = centrality;                                               // Axis 5: Centrality
-            fHistograms->fhTrackPairs->Fill(fillerTrackPair, std::get<kTrackEfficiency>(selectedTrackInformation.at(iTrack)) * std::get<kTrackEfficiency>(selectedTrackInformation.at(jTrack)) * fTotalEventWeight);  // Fill the track pair histogram
-          }
-          
-        } // Inner track loop
-      } // Outer track loop
+      // Go through all the pairs closer than DeltaR = 0.8. Tracks failing the trigger cuts are not used as the
+      // trigger particle, which is always the one with higher pT. The pairs are filled to the track pair histogram.
+      fTrackPairEngine.SetTracks(fSelectedTracks, true);
+      fTrackPairSink.FillPairs(fTrackPairEngine, fSelectedTracks);
       
       // Do the same for generator level tracks in case for running with Monte Carlo
       if(fDataType == ForestReader::kPpMC || fDataType == ForestReader::kPbPbMC){
        
-        // Clear the track vectors
-        selectedTrackInformation.clear();
+        // Clear the selected track buffer
+        fSelectedParticles.Clear();
         
         nTracks = fEventReader->GetNGenParticles();
         for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
@@ -536,7 +657,7 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
           trackPt = fEventReader->GetGenParticlePt(iTrack);
           trackEta = fEventReader->GetGenParticleEta(iTrack);
           trackPhi = fEventReader->GetGenParticlePhi(iTrack);
-          selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, 1));
+          fSelectedParticles.AddTrack(trackPt, trackEta, trackPhi, 1);
           
           // Fill track histograms
           fillerTrack[0] = trackPt;      // Axis 0: Generator level particle pT
@@ -546,42 +667,20 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
           fHistograms->fhGenParticle->Fill(fillerTrack,fTotalEventWeight);  // Fill the generator level particle histogram
         }
         
-        // Sort the vector such that the larger track pT will always be assigned to the first slot
-        std::sort(selectedTrackInformation.begin(), selectedTrackInformation.end(), std::greater<std::tuple<double,double,double,double>>());
+        // Sort the tracks such that the larger track pT will always be assigned to the first slot
+        fSelectedParticles.SortByPt();
         
-        // Once we have looped over all the tracks, only loop over tracks that pass the cuts to construct all possible track pairings
-        for(Int_t iTrack = 0; iTrack < selectedTrackInformation.size(); iTrack++){
-          
-          // For generator level particles, apply the same cuts as for reconstructed ones in order to get consistent yields
-          if(TMath::Abs(std::get<kTrackEta>(selectedTrackInformation.at(iTrack))) > fTriggerEtaCut) continue;  // Stricter eta cut for trigger particles
-          if(fCutBadPhiRegionTrigger && (std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)) > -0.1 && std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)) < 1.2)) continue; // Do not let the trigger particle to be in the phi region with bad tracker performance
-          
-          for(Int_t jTrack = iTrack+1; jTrack < selectedTrackInformation.size(); jTrack++){
-
-            // Calculate the distance of the two tracks from each other
-            pairDeltaR = GetDeltaR(std::get<kTrackEta>(selectedTrackInformation.at(iTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)), std::get<kTrackEta>(selectedTrackInformation.at(jTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(jTrack)));
-
-            // Fill the track pair histograms for tracks relatively close to each other
-            if(pairDeltaR < 0.8){
-
-              // Calculate the average pair eta and phi positions
-              averagePairEta = (std::get<kTrackEta>(selectedTrackInformation.at(iTrack))+std::get<kTrackEta>(selectedTrackInformation.at(jTrack)))/2.0;
-              averagePairPhi = GetAveragePhi(std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(jTrack)));
-
-              fillerTrackPair[0] = pairDeltaR;                                               // Axis 0: DeltaR between the two tracks
-              fillerTrackPair[1] = std::get<kTrackPt>(selectedTrackInformation.at(iTrack));  // Axis 1: Higher particle pT
-              fillerTrackPair[2] = std::get<kTrackPt>(selectedTrackInformation.at(jTrack));  // Axis 2: Lower particle pT
-              fillerTrackPair[3] = averagePairPhi;                                           // Axis 3: Average pair phi
-              fillerTrackPair[4] = averagePairEta;                                           // Axis 4: Average pair eta
-              fillerTrackPair[5] = centrality;                                               // Axis 5: Centrality
-              fHistograms->fhGenParticlePairs->Fill(fillerTrackPair,fTotalEventWeight);      // Fill the track pair histogram
-            }
-
-          } // Inner track loop
-        } // Outer track loop
+        // Go through all the pairs closer than DeltaR = 0.8. For generator level particles, apply the same trigger
+        // cuts as for reconstructed ones in order to get consistent yields.
+        fTrackPairEngine.SetTracks(fSelectedParticles, true);
+        fGenParticlePairSink.FillPairs(fTrackPairEngine, fSelectedParticles);
         
       } // If for Monte Carlo particles
       
+      // Index the selected tracks and particles once per event for finding the jet cones
+      BuildTrackPairGrid(fSelectedTracks, fTrackConeGrid);
+      BuildTrackPairGrid(fSelectedParticles, fParticleConeGrid);
+      
       
       //***********************************************************************
       //        Loop over all jets and fill inclusive jet histograms
@@ -637,56 +736,19 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
         //         Find all the tracks that are close to this jet and fill the pair efficiency histograms for them
         //******************************************************************************************************************
 
-        // Clear the selected track vectors
-        selectedTrackInformation.clear();
+        // Find the selected tracks inside the jet cone from the event level table
+        CollectTracksInJetCone(fSelectedTracks, fTrackConeGrid, jetEta, jetPhi, fJetConeIndices);
 
-        // Loop over all track in the event
-        nTracks = fEventReader->GetNTracks();
-        for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
-        
-          // Check that all the track cuts are passed
-          if(!PassTrackCuts(fEventReader,iTrack,fHistograms->fhTrackCuts,true)) continue;
-        
-          // Get the track information and add it to vector
-          trackPt = fEventReader->GetTrackPt(iTrack);
-          trackEta = fEventReader->GetTrackEta(iTrack);
-          trackPhi = fEventReader->GetTrackPhi(iTrack);
-          trackEfficiency = GetTrackEfficiencyCorrection(iTrack);
-
-          if(GetDeltaR(jetEta, jetPhi, trackEta, trackPhi) < 0.4){
-            selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, trackEfficiency));
-          }
-        
-        } // Track loop
-
-        FillTrackPairsCloseToJets(selectedTrackInformation, jetPt, centrality, TrackPairEfficiencyHistograms::kReconstructed, fHistograms->fhTrackPairsCloseToJet);
+        FillTrackPairsCloseToJets(fSelectedTracks, fJetConeIndices, jetPt, TrackPairEfficiencyHistograms::kReconstructed, fTrackPairCloseToJetSink);
 
         //******************************************************************************************************************
         //        Find all the particles that are close to this jet and fill the pair efficiency histograms for them
         //******************************************************************************************************************
 
-        // Clear the selected track vectors
-        selectedTrackInformation.clear();
+        // Find the selected particles inside the jet cone from the event level table
+        CollectTracksInJetCone(fSelectedParticles, fParticleConeGrid, jetEta, jetPhi, fJetConeIndices);
 
-        // Loop over all track in the event
-        nTracks = fEventReader->GetNGenParticles();
-        for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
-        
-          // Check that all the track cuts are passed
-          if(!PassGenParticleSelection(fEventReader,iTrack,fHistograms->fhGenParticleSelections,true)) continue;
-        
-          // Get the track information and add it to vector
-          trackPt = fEventReader->GetGenParticlePt(iTrack);
-          trackEta = fEventReader->GetGenParticleEta(iTrack);
-          trackPhi = fEventReader->GetGenParticlePhi(iTrack);
-
-          if(GetDeltaR(jetEta, jetPhi, trackEta, trackPhi) < 0.4){
-            selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, 1));
-          }
-        
-        } // Generator level particle loop
-
-        FillTrackPairsCloseToJets(selectedTrackInformation, jetPt, centrality, TrackPairEfficiencyHistograms::kReconstructed, fHistograms->fhGenParticlePairsCloseToJet);
+        FillTrackPairsCloseToJets(fSelectedParticles, fJetConeIndices, jetPt, TrackPairEfficiencyHistograms::kReconstructed, fGenParticlePairCloseToJetSink);
 
       } // End of jet loop
       
@@ -729,56 +791,19 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
           //         Find all the tracks that are close to this jet and fill the pair efficiency histograms for them
           //******************************************************************************************************************
 
-          // Clear the selected track vectors
-          selectedTrackInformation.clear();
-
-          // Loop over all track in the event
-          nTracks = fEventReader->GetNTracks();
-          for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+          // Find the selected tracks inside the jet cone from the event level table
+          CollectTracksInJetCone(fSelectedTracks, fTrackConeGrid, jetEta, jetPhi, fJetConeIndices);
 
-            // Check that all the track cuts are passed
-            if(!PassTrackCuts(fEventReader, iTrack, fHistograms->fhTrackCuts, true)) continue;
-
-            // Get the track information and add it to vector
-            trackPt = fEventReader->GetTrackPt(iTrack);
-            trackEta = fEventReader->GetTrackEta(iTrack);
-            trackPhi = fEventReader->GetTrackPhi(iTrack);
-            trackEfficiency = GetTrackEfficiencyCorrection(iTrack);
-
-            if(GetDeltaR(jetEta, jetPhi, trackEta, trackPhi) < 0.4){
-              selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, trackEfficiency));
-            }
-
-          }  // Track loop
-
-          FillTrackPairsCloseToJets(selectedTrackInformation, jetPt, centrality, TrackPairEfficiencyHistograms::kGeneratorLevel, fHistograms->fhTrackPairsCloseToJet);
+          FillTrackPairsCloseToJets(fSelectedTracks, fJetConeIndices, jetPt, TrackPairEfficiencyHistograms::kGeneratorLevel, fTrackPairCloseToJetSink);
 
           //******************************************************************************************************************
           //        Find all the particles that are close to this jet and fill the pair efficiency histograms for them
           //******************************************************************************************************************
 
-          // Clear the selected track vectors
-          selectedTrackInformation.clear();
-
-          // Loop over all track in the event
-          nTracks = fEventReader->GetNGenParticles();
-          for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
-
-            // Check that all the track cuts are passed
-            if(!PassGenParticleSelection(fEventReader, iTrack, fHistograms->fhGenParticleSelections, true)) continue;
-
-            // Get the track information and add it to vector
-            trackPt = fEventReader->GetGenParticlePt(iTrack);
-            trackEta = fEventReader->GetGenParticleEta(iTrack);
-            trackPhi = fEventReader->GetGenParticleEta(iTrack);
-
-            if(GetDeltaR(jetEta, jetPhi, trackEta, trackPhi) < 0.4){
-              selectedTrackInformation.push_back(std::make_tuple(trackPt, trackEta, trackPhi, 1));
-            }
-
-          }  // Track loop
+          // Find the selected particles inside the jet cone from the event level table
+          CollectTracksInJetCone(fSelectedParticles, fParticleConeGrid, jetEta, jetPhi, fJetConeIndices);
 
-          FillTrackPairsCloseToJets(selectedTrackInformation, jetPt, centrality, TrackPairEfficiencyHistograms::kGeneratorLevel, fHistograms->fhGenParticlePairsCloseToJet);
+          FillTrackPairsCloseToJets(fSelectedParticles, fJetConeIndices, jetPt, TrackPairEfficiencyHistograms::kGeneratorLevel, fGenParticlePairCloseToJetSink);
 
         } // End of jet loop
         
@@ -791,52 +816,86 @@ void TrackPairEfficiencyAnalyzer::RunAnalysis(){
     //      Cleanup at the end of the file loop
     //************************************************
     
-    // Close the input files after the event has been read
-    inputFile->Close();
+    // Close the input files after the event has been read. The trees are deleted with the file, so disconnect them first.
+    fEventReader->DisconnectForest();
+    if(inputFile) inputFile->Close();
+    delete selectedEvents;
     
   } // File loop
   
+  // Fill the pairs remaining in the buffers to the histograms
+  fTrackPairSink.Flush();
+  fGenParticlePairSink.Flush();
+  fTrackPairCloseToJetSink.Flush();
+  fGenParticlePairCloseToJetSink.Flush();
+  
+  // Report how much data was read from the track tree
+  if(fDebugLevel > 0) fEventReader->PrintTrackColumnReadStatistics();
+  
+  // Report the time spent decompressing the forest trees to see the effect of the decompression threads
+  if(fDebugLevel > 0) fEventReader->PrintTreeUnzipTimes();
+  
+  // Report the histogram memory to see how much of the dense pair histograms is filled
+  if(fDebugLevel > 0) fHistograms->PrintMemoryReport();
+  
 }
 
 /*
  * Fill the histograms for track pairs close to jets
  *
  *  Arguments:
- *   vector<std::tuple<double,double,double,double>> selectedTrackInformation = pT, eta, phi and efficiency information for tracks that are paired and close to jets
+ *   const SelectedTrackBuffer &eventTracks = pT, eta, phi and efficiency information for the tracks passing the cuts in the event. The tracks are sorted in pT.
+ *   const std::vector<Int_t> &coneIndices = Indices of the tracks close to the jet in the event level table, in increasing order
  *   Double_t jetPt = pT of the jets these tracks are close to
- *   Double_t centrality = Centrality of the event
  *   Int_t iDataLevel = 0: Reconstructed jets, 1 = Generator level jets
- *   THnSparseF* filledHistogram = Histogram to which the pairs are filled
+ *   TrackPairSink<JetConePairAxes> &pairSink = Filler for the histogram to which the pairs are filled. Centrality and event weight must be already bound.
  */
-void TrackPairEfficiencyAnalyzer::FillTrackPairsCloseToJets(vector<std::tuple<double,double,double,double>> selectedTrackInformation, Double_t jetPt, Double_t centrality, Int_t iDataLevel, THnSparseF* filledHistogram){
-
-  // Helper variables
-  Double_t fillerTrackPair[6];      // Track pair histogram filler
-  Double_t pairDeltaR;
+void TrackPairEfficiencyAnalyzer::FillTrackPairsCloseToJets(const SelectedTrackBuffer &eventTracks, const std::vector<Int_t> &coneIndices, Double_t jetPt, Int_t iDataLevel, TrackPairSink<JetConePairAxes> &pairSink){
 
-  // Sort the vector such that the larger track pT will always be assigned to the first slot
-  std::sort(selectedTrackInformation.begin(), selectedTrackInformation.end(), std::greater<std::tuple<double, double, double, double>>());
+  // Jet pT and data level are the same for all the pairs of this jet
+  pairSink.BindAxis(JetConePairAxes::kJetPt, jetPt);
+  pairSink.BindAxis(JetConePairAxes::kDataLevel, iDataLevel);
 
-  // Loop over the sorted tracks
-  for(Int_t iTrack = 0; iTrack < selectedTrackInformation.size(); iTrack++) {
-    for(Int_t jTrack = iTrack + 1; jTrack < selectedTrackInformation.size(); jTrack++) {
-
-      // Calculate the distance of the two tracks from each other
-      pairDeltaR = GetDeltaR(std::get<kTrackEta>(selectedTrackInformation.at(iTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(iTrack)), std::get<kTrackEta>(selectedTrackInformation.at(jTrack)), std::get<kTrackPhi>(selectedTrackInformation.at(jTrack)));
+  // The event level table is sorted in pT and the cone indices are in increasing order, so the larger track pT
+  // is always assigned to the first slot. Two tracks inside a cone of R = 0.4 are always closer than DeltaR = 0.8
+  // to each other, so all the pairs in the cone are checked directly.
+  fTrackPairEngine.SetTracks(eventTracks, coneIndices, false);
+  pairSink.FillPairs(fTrackPairEngine, eventTracks);
+}
 
-      // Fill the track pair histograms for tracks relatively close to each other
-      if(pairDeltaR < 0.8){
-        fillerTrackPair[0] = pairDeltaR;                                                // Axis 0: DeltaR between the two tracks
-        fillerTrackPair[1] = std::get<kTrackPt>(selectedTrackInformation.at(iTrack));   // Axis 1: Higher particle pT
-        fillerTrackPair[2] = std::get<kTrackPt>(selectedTrackInformation.at(jTrack));   // Axis 2: Lower particle pT
-        fillerTrackPair[3] = jetPt;                                                     // Axis 3: Jet pT
-        fillerTrackPair[4] = iDataLevel;                                                // Axis 4: Reconstructed/generator level jet
-        fillerTrackPair[5] = centrality;                                                // Axis 5: Centrality
-        filledHistogram->Fill(fillerTrackPair, std::get<kTrackEfficiency>(selectedTrackInformation.at(iTrack)) * std::get<kTrackEfficiency>(selectedTrackInformation.at(jTrack)) * fTotalEventWeight);  // Fill the track pair histogram close to jets
-      }
+/*
+ * Collect the indices of the tracks inside a jet cone from the event level table of selected tracks.
+ * Only the tracks in the grid cells overlapping with the cone are checked.
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &eventTracks = Tracks passing the cuts in the event, together with their efficiency corrections
+ *   TrackPairGrid &eventGrid = Eta-phi grid built from eventTracks with cells at least 0.4 wide
+ *   const Double_t jetEta = Eta of the jet axis
+ *   const Double_t jetPhi = Phi of the jet axis
+ *   std::vector<Int_t> &coneIndices = Vector to which the indices of the tracks within DeltaR < 0.4 from the jet axis are collected in increasing order
+ */
+void TrackPairEfficiencyAnalyzer::CollectTracksInJetCone(const SelectedTrackBuffer &eventTracks, TrackPairGrid &eventGrid, const Double_t jetEta, const Double_t jetPhi, std::vector<Int_t> &coneIndices){
+  coneIndices.clear();
+  for(const Int_t iTrack : eventGrid.FindConeCandidates(jetEta, jetPhi)){
+    if(GetDeltaR(jetEta, jetPhi, eventTracks.GetEta(iTrack), eventTracks.GetPhi(iTrack)) < 0.4){
+      coneIndices.push_back(iTrack);
+    }
+  }
+}
 
-    }  // Inner track loop
-  }    // Outer track loop
+/*
+ * Sort the selected tracks to an eta-phi grid
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &selectedTracks = pT, eta, phi and efficiency information for tracks that are paired. The grid uses the same track indices.
+ *   TrackPairGrid &trackGrid = Grid to which the tracks are sorted
+ */
+void TrackPairEfficiencyAnalyzer::BuildTrackPairGrid(const SelectedTrackBuffer &selectedTracks, TrackPairGrid &trackGrid){
+  trackGrid.Clear();
+  for(Int_t iTrack = 0; iTrack < selectedTracks.GetNTracks(); iTrack++){
+    trackGrid.AddTrack(selectedTracks.GetEta(iTrack), selectedTracks.GetPhi(iTrack));
+  }
+  trackGrid.Build();
 }
 
 /*
@@ -883,39 +942,92 @@ Double_t TrackPairEfficiencyAnalyzer::GetJetPtWeight(const Double_t jetPt) const
   return fPtWeightFunction->Eval(jetPt);
 }
 
+/*
+ * Find the events passing the event cuts using the event selection index. The index is read from a sidecar file
+ * next to the forest. If there is no valid index, it is built from the event level trees of the forest and
+ * written to the sidecar file for the following runs. The event cuts are counted for all the events here.
+ *
+ *  Arguments:
+ *   TFile *inputFile = File containing the forest. NULL for mapped forest files.
+ *   const TString forestFileName = Name of the forest file
+ *
+ *   return: List of the events in the forest passing the pT hat and event cuts
+ */
+TEntryList* TrackPairEfficiencyAnalyzer::SelectEventsFromIndex(TFile *inputFile, const TString forestFileName){
+  
+  // Use a separate reader for the index, such that the analysis reader can still read the forest from the beginning
+  ForestReader *indexReader = new ForestReader(fDataType, fJetType, fJetAxis, fUseTrigger);
+  if(inputFile){
+    indexReader->ReadForestFromFile(inputFile);
+  } else {
+    indexReader->ReadMappedForestFromFile(forestFileName);
+  }
+  
+  // Read the index from the sidecar file or build it if the file does not match the forest
+  EventSelectionIndex eventIndex;
+  TString indexFileName = EventSelectionIndex::GetIndexFileName(forestFileName);
+  TString indexDescription = Form("Event index. Data type %d, trigger %d", fDataType, fUseTrigger);
+  TString forestIdentity = EventSelectionIndex::GetForestIdentity(inputFile, forestFileName);
+  if(!eventIndex.ReadIndex(indexFileName, indexReader->GetNEvents(), indexDescription, forestIdentity)){
+    if(fDebugLevel > 0) cout << "Building event index: " << indexFileName.Data() << endl;
+    eventIndex.BuildIndex(indexReader);
+    eventIndex.WriteIndex(indexFileName, indexDescription, forestIdentity);
+  }
+  
+  // The index reader shares the trees with the analysis reader. Deleting it detaches its statistics from the trees.
+  delete indexReader;
+  
+  // Apply the pT hat and event cuts to all the events in the index
+  TEntryList *selectedEvents = new TEntryList();
+  for(Long64_t iEvent = 0; iEvent < eventIndex.GetNEvents(); iEvent++){
+    const EventSelectionIndex::EventInformation &eventInformation = eventIndex.GetEventInformation(iEvent);
+    
+    if(eventInformation.fPtHat < fMinimumPtHat || eventInformation.fPtHat >= fMaximumPtHat) continue;
+    fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kAll);
+    
+    if(!PassEventCuts(eventInformation, false)) continue;
+    selectedEvents->Enter(iEvent);
+  }
+  
+  if(fDebugLevel > 0) cout << "Event index selected " << selectedEvents->GetN() << " out of " << eventIndex.GetNEvents() << " events" << endl;
+  
+  return selectedEvents;
+}
+
 /*
  * Check if the event passes all the event cuts
  *
  *  Arguments:
- *   ForestReader *eventReader = ForestReader containing the event information checked for event cuts
+ *   const EventSelectionIndex::EventInformation &eventInformation = Event level information checked for event cuts
+ *   const Bool_t bypassFill = Pass filling the event counter histogram
  *
  *   return = True if all event cuts are passed, false otherwise
  */
-Bool_t TrackPairEfficiencyAnalyzer::PassEventCuts(ForestReader *eventReader){
+Bool_t TrackPairEfficiencyAnalyzer::PassEventCuts(const EventSelectionIndex::EventInformation &eventInformation, const Bool_t bypassFill){
 
   // Primary vertex has at least two tracks, is within 25 cm in z-rirection and within 2 cm in xy-direction. Only applied for data.
-  if(eventReader->GetPrimaryVertexFilterBit() == 0) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kPrimaryVertex);
+  if(eventInformation.fPrimaryVertexFilterBit == 0) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kPrimaryVertex);
   
   // Have at least two HF towers on each side of the detector with an energy deposit of 4 GeV. Only applied for PbPb data.
-  if(eventReader->GetHfCoincidenceFilterBit() == 0) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kHfCoincidence);
+  if(eventInformation.fHfCoincidenceFilterBit == 0) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kHfCoincidence);
   
   // Calculated from pixel clusters. Ensures that measured and predicted primary vertices are compatible. Only applied for PbPb data.
-  if(eventReader->GetClusterCompatibilityFilterBit() == 0) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kClusterCompatibility);
+  if(eventInformation.fClusterCompatibilityFilterBit == 0) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kClusterCompatibility);
   
   // Cut for beam scraping. Only applied for pp data.
-  if(eventReader->GetBeamScrapingFilterBit() == 0) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kBeamScraping);
+  if(eventInformation.fBeamScrapingFilterBit == 0) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kBeamScraping);
   
   // Jet trigger requirement.
-  if(eventReader->GetJetFilterBit() == 0) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kCaloJet);
+  if(eventInformation.fJetFilterBit == 0) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kCaloJet);
   
   // Cut for vertex z-position
-  if(TMath::Abs(eventReader->GetVz()) > fVzCut) return false;
-  fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kVzCut);
+  if(TMath::Abs(eventInformation.fVertexZ) > fVzCut) return false;
+  if(!bypassFill) fHistograms->fhEvents->Fill(TrackPairEfficiencyHistograms::kVzCut);
   
   return true;
   
@@ -964,76 +1076,38 @@ Bool_t TrackPairEfficiencyAnalyzer::PassGenParticleSelection(ForestReader *track
 
 
 /*
- * Check if a track passes all the track cuts
+ * Add the numbers of tracks passing the track cuts in the event to the track cut histogram. This gives the same
+ * histogram as filling each track to the bins of the cuts it passes with unit weight.
  *
  *  Arguments:
- *   ForestReader *trackReader = ForestReader from which the tracks are read
- *   const Int_t iTrack = Index of the checked track in reader
- *   TH1F *trackCutHistogram = Histogram to which the track cut performance is filled
- *   const Bool_t bypassFill = Pass filling the track cut histograms
- *
- *   return: True if all track cuts are passed, false otherwise
+ *   TH1F *trackCutHistogram = Histogram to which the numbers of tracks passing the cuts are added
  */
-Bool_t TrackPairEfficiencyAnalyzer::PassTrackCuts(ForestReader *trackReader, const Int_t iTrack, TH1F *trackCutHistogram, const Bool_t bypassFill){
-  
-  // Only fill the track cut histograms for same event data
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kAllTracks);
-  
-  Double_t trackPt = trackReader->GetTrackPt(iTrack);
-  Double_t trackEta = trackReader->GetTrackEta(iTrack);
-  Double_t trackEt = (trackReader->GetTrackEnergyEcal(iTrack)+trackReader->GetTrackEnergyHcal(iTrack))/TMath::CosH(trackEta);
-  
-  //  ==== Apply cuts for tracks and collect information on how much track are cut in each step ====
-  
-  // Cut for track pT
-  if(trackPt <= fTrackMinPtCut) return false;                 // Minimum track pT cut
-  if(trackPt >= fTrackMaxPtCut) return false;                 // Maximum track pT cut
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kPtCuts);
-  
-  // Cut for track eta
-  if(TMath::Abs(trackEta) >= fTrackEtaCut) return false;          // Eta cut
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kEtaCut);
-  
-  // Cut for high purity
-  if(!trackReader->GetTrackHighPurity(iTrack)) return false;     // High purity cut
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kHighPurity);
-  
-  // Cut for relative error for track pT
-  if(trackReader->GetTrackPtError(iTrack)/trackPt >= fMaxTrackPtRelativeError) return false; // Cut for track pT relative error
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kPtError);
-  
-  // Cut for track distance from primary vertex
-  if(TMath::Abs(trackReader->GetTrackVertexDistanceZ(iTrack)/trackReader->GetTrackVertexDistanceZError(iTrack)) >= fMaxTrackDistanceToVertex) return false; // Mysterious cut about track proximity to vertex in z-direction
-  if(TMath::Abs(trackReader->GetTrackVertexDistanceXY(iTrack)/trackReader->GetTrackVertexDistanceXYError(iTrack)) >= fMaxTrackDistanceToVertex) return false; // Mysterious cut about track proximity to vertex in xy-direction
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kVertexDistance);
-  
-  // Cut for energy deposition in calorimeters for high pT tracks
-  if(!(trackPt < fCalorimeterSignalLimitPt || (trackEt >= fHighPtEtFraction*trackPt))) return false;  // For high pT tracks, require signal also in calorimeters
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kCaloSignal);
-  
-  // Cuts for track reconstruction quality
-  //if( trackReader->GetTrackChi2(iTrack) / (1.0*trackReader->GetNTrackDegreesOfFreedom(iTrack)) / (1.0*trackReader->GetNHitsTrackerLayer(iTrack)) >= fChi2QualityCut) return false; // Track reconstruction quality cut
-  if(trackReader->GetTrackNormalizedChi2(iTrack) / (1.0*trackReader->GetNHitsTrackerLayer(iTrack)) >= fChi2QualityCut) return false; // Track reconstruction quality cut
-  if(trackReader->GetNHitsTrack(iTrack) < fMinimumTrackHits) return false; // Cut for minimum number of hits per track
-  if(!bypassFill) trackCutHistogram->Fill(TrackPairEfficiencyHistograms::kReconstructionQuality);
-  
-  // If passed all checks, return true
-  return true;
+void TrackPairEfficiencyAnalyzer::FillTrackCutCounts(TH1F *trackCutHistogram) const{
+  Double_t nFills = 0;
+  Double_t nEntries = trackCutHistogram->GetEntries();
+  for(Int_t iCut = 0; iCut < TrackPairEfficiencyHistograms::knTrackCuts; iCut++){
+    const Int_t nPassed = fTrackCutKernel.GetNPassed(iCut);
+    trackCutHistogram->AddBinContent(iCut+1, nPassed);
+    trackCutHistogram->GetSumw2()->GetArray()[iCut+1] += nPassed; // Each track has unit weight. AddAt would overwrite the sum.
+    nFills += nPassed;
+  }
+  trackCutHistogram->SetEntries(nEntries + nFills);
 }
 
 /*
  * Get the track efficiency correction for a given track
  *
  *  Arguments:
+ *   const ForestReader::EventView &eventView = View of the current event from which the tracks are read
  *   const Int_t iTrack = Index of the track for which the efficiency correction is obtained
  *
  *   return: Multiplicative track efficiency correction
  */
-Double_t TrackPairEfficiencyAnalyzer::GetTrackEfficiencyCorrection(const Int_t iTrack){
+Double_t TrackPairEfficiencyAnalyzer::GetTrackEfficiencyCorrection(const ForestReader::EventView &eventView, const Int_t iTrack){
   
   // Get track information
-  Float_t trackPt = fEventReader->GetTrackPt(iTrack);    // Track pT
-  Float_t trackEta = fEventReader->GetTrackEta(iTrack);  // Track eta
+  Float_t trackPt = eventView.fTrackPt[iTrack];    // Track pT
+  Float_t trackEta = eventView.fTrackEta[iTrack];  // Track eta
   Int_t hiBin = fEventReader->GetHiBin();                // hiBin for 2018 track correction
   
   // Get the correction using the track and event information
@@ -1108,24 +1182,3 @@ Double_t TrackPairEfficiencyAnalyzer::GetDeltaR(const Double_t eta1, const Doubl
   return TMath::Sqrt(deltaPhi*deltaPhi + deltaEta*deltaEta);
   
 }
-
-/*
- * Get an average phi value of two phi values
- */
-Double_t TrackPairEfficiencyAnalyzer::GetAveragePhi(const Double_t phi1, const Double_t phi2) const{
-  
-  // There is a special case when the values are closer to pi than zero, when the average should also be pi rather than zero
-  if((phi1 > TMath::Pi()/2.0 && phi2 < -TMath::Pi()+phi1) || (phi1 < -TMath::Pi()/2.0 && phi2 > TMath::Pi()-phi1) || (phi2 > TMath::Pi()/2.0 && phi1 < -TMath::Pi()+phi2) || (phi2 < -TMath::Pi()/2.0 && phi1 > TMath::Pi()-phi2)){
-    
-    // Check if we need to rotate to negative of positive side
-    if(phi1+phi2 > 0){
-      return -TMath::Pi() + ((phi1+phi2)/2.0);
-    }
-    
-    return TMath::Pi() + ((phi1+phi2)/2.0);
-    
-  }
-  
-  // If we are not in the special case, return the simple average
-  return (phi1+phi2)/2.0;
-}
@@ -16,21 +16,27 @@
 #include <TString.h>
 #include <TRandom3.h>
 #include <TMath.h>
+#include <TEntryList.h>
 
 // Own includes
 #include "ConfigurationCard.h"
 #include "TrackPairEfficiencyHistograms.h"
 #include "ForestReader.h"
+#include "EventSelectionIndex.h"
 #include "trackingEfficiency2018PbPb.h"
 #include "trackingEfficiency2017pp.h"
 #include "TrackingEfficiencyInterface.h"
+#include "TrackPairGrid.h"
+#include "SelectedTrackBuffer.h"
+#include "TrackPairEngine.h"
+#include "TrackPairSink.h"
+#include "TrackCutKernel.h"
 
 class TrackPairEfficiencyAnalyzer{
   
 private:
   
   enum enumSubeventCuts{kSubeventZero,kSubeventNonZero,kSubeventAny,knSubeventCuts}; // Cuts for subevent index
-  enum enumTupleDecoder{kTrackPt, kTrackEta, kTrackPhi, kTrackEfficiency}; // Components of the n-tuple in track vector
   
 public:
   
@@ -49,22 +55,24 @@ private:
   
   // Private methods
   void ReadConfigurationFromCard(); // Read all the configuration from the input card
-  void FillTrackPairsCloseToJets(vector<std::tuple<double,double,double,double>> selectedTrackInformation, Double_t jetPt, Double_t centrality, Int_t iDataLevel, THnSparseF* filledHistogram); // Fill the histograms with track pairs close to jets
+  void FillTrackPairsCloseToJets(const SelectedTrackBuffer &eventTracks, const std::vector<Int_t> &coneIndices, Double_t jetPt, Int_t iDataLevel, TrackPairSink<JetConePairAxes> &pairSink); // Fill the histograms with track pairs close to jets
+  void BuildTrackPairGrid(const SelectedTrackBuffer &selectedTracks, TrackPairGrid &trackGrid); // Sort the selected tracks to an eta-phi grid
+  void CollectTracksInJetCone(const SelectedTrackBuffer &eventTracks, TrackPairGrid &eventGrid, const Double_t jetEta, const Double_t jetPhi, std::vector<Int_t> &coneIndices); // Collect the indices of the tracks inside a jet cone from the event level table
   
-  Bool_t PassEventCuts(ForestReader *eventReader); // Check if the event passes the event cuts
+  TEntryList* SelectEventsFromIndex(TFile *inputFile, const TString forestFileName); // Find the events passing the event cuts using the event selection index
+  Bool_t PassEventCuts(const EventSelectionIndex::EventInformation &eventInformation, const Bool_t bypassFill); // Check if the event passes the event cuts
   Double_t GetVzWeight(const Double_t vz) const;  // Get the proper vz weighting depending on analyzed system
   Double_t GetCentralityWeight(const Int_t hiBin) const; // Get the proper centrality weighting depending on analyzed system
   Double_t GetJetPtWeight(const Double_t jetPt) const; // Get the proper jet pT weighting for 2017 and 2018 MC
   
   Bool_t PassGenParticleSelection(ForestReader *trackReader, const Int_t iTrack, TH1F *trackCutHistogram, const Bool_t bypassFill);
-  Bool_t PassTrackCuts(ForestReader *trackReader, const Int_t iTrack, TH1F *trackCutHistogram, const Bool_t bypassFill);
+  void FillTrackCutCounts(TH1F *trackCutHistogram) const; // Add the numbers of tracks passing the track cuts in the event to the histogram
   Bool_t PassSubeventCut(const Int_t subeventIndex) const;  // Check if the track passes the set subevent cut
   
-  Double_t GetTrackEfficiencyCorrection(const Int_t iTrack); // Get the track efficiency correction for a given track
+  Double_t GetTrackEfficiencyCorrection(const ForestReader::EventView &eventView, const Int_t iTrack); // Get the track efficiency correction for a given track
   Double_t  GetTrackEfficiencyCorrection(const Float_t trackPt, const Float_t trackEta, const Int_t hiBin); // Get the track efficiency correction for given track and event information
   
   Double_t GetDeltaR(const Double_t eta1, const Double_t phi1, const Double_t eta2, const Double_t phi2) const; // Get deltaR between two objects
-  Double_t GetAveragePhi(const Double_t phi1, const Double_t phi2) const; // Get an average of two phi values
   
   // Private data members
   ForestReader *fEventReader;               // Reader for objects in the event
@@ -82,6 +90,11 @@ private:
   Int_t fJetType;                    // Type of jets used for analysis. 0 = Calo jets, 1 = PF jets
   Bool_t fUseTrigger;                // Flag for applying the jet trigger. False = Do not use jet trigger. True = Use jet trigger
   Int_t fDebugLevel;                 // Amount of debug messages printed to console
+  Bool_t fReadTrackColumnsOnDemand;  // Flag for reading track branches only when they are needed instead of reading full track tree entries
+  Double_t fTreeCacheSize;           // Total read cache budget for the forest trees in MB
+  Bool_t fAsyncPrefetch;             // Flag for asynchronous prefetching of the next cluster to the read cache
+  Bool_t fUseEventIndex;             // Flag for applying the event cuts from an event selection index and reading only the selected events
+  Int_t fNumberOfThreads;            // Number of threads used for decompressing the forest baskets
   
   // Weights for filling the MC histograms
   Double_t fVzWeight;                // Weight for vz in MC
@@ -114,6 +127,20 @@ private:
   Double_t fChi2QualityCut;            // Quality cut for track reconstruction
   Double_t fMinimumTrackHits;          // Quality cut for track hits
   Int_t fSubeventCut;                  // Cut for the subevent index
+  
+  TrackCutKernel fTrackCutKernel;      // Kernel evaluating the track cuts for all the tracks in the event
+  
+  // Pair finding
+  SelectedTrackBuffer fSelectedTracks;    // Track pT, eta, phi and efficiency for tracks passing the cuts in the event
+  SelectedTrackBuffer fSelectedParticles; // Particle pT, eta and phi for generator level particles passing the selection in the event
+  std::vector<Int_t> fJetConeIndices;     // Indices of the tracks or particles inside the jet cone in the event level table
+  TrackPairGrid fTrackConeGrid;        // Eta-phi grid of the selected tracks in the event for finding the tracks in jet cones
+  TrackPairGrid fParticleConeGrid;     // Eta-phi grid of the selected particles in the event for finding the particles in jet cones
+  TrackPairEngine fTrackPairEngine;    // Enumeration of the track pairs with DeltaR < 0.8 for the inclusive and jet cone pairs
+  TrackPairSink<InclusivePairAxes> fTrackPairSink;                // Filler for the inclusive track pair histogram
+  TrackPairSink<InclusivePairAxes> fGenParticlePairSink;          // Filler for the inclusive generator level particle pair histogram
+  TrackPairSink<JetConePairAxes> fTrackPairCloseToJetSink;        // Filler for the histogram of track pairs close to jets
+  TrackPairSink<JetConePairAxes> fGenParticlePairCloseToJetSink;  // Filler for the histogram of generator level particle pairs close to jets
 
 };
 
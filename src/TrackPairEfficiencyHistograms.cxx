@@ -29,9 +29,12 @@ TrackPairEfficiencyHistograms::TrackPairEfficiencyHistograms() :
   fhInclusiveJet(0),
   fhTrackPairs(0),
   fhGenParticlePairs(0),
+  fhTrackPairSlices(0),
+  fhGenParticlePairSlices(0),
   fhTrackPairsCloseToJet(0),
   fhGenParticlePairsCloseToJet(0),
-  fCard(0)
+  fCard(0),
+  fFillDeltaRSlices(false)
 {
   // Default constructor
   
@@ -56,9 +59,12 @@ TrackPairEfficiencyHistograms::TrackPairEfficiencyHistograms(ConfigurationCard *
   fhInclusiveJet(0),
   fhTrackPairs(0),
   fhGenParticlePairs(0),
+  fhTrackPairSlices(0),
+  fhGenParticlePairSlices(0),
   fhTrackPairsCloseToJet(0),
   fhGenParticlePairsCloseToJet(0),
-  fCard(newCard)
+  fCard(newCard),
+  fFillDeltaRSlices(false)
 {
   // Custom constructor
 
@@ -83,9 +89,12 @@ TrackPairEfficiencyHistograms::TrackPairEfficiencyHistograms(const TrackPairEffi
   fhInclusiveJet(in.fhInclusiveJet),
   fhTrackPairs(in.fhTrackPairs),
   fhGenParticlePairs(in.fhGenParticlePairs),
+  fhTrackPairSlices(in.fhTrackPairSlices),
+  fhGenParticlePairSlices(in.fhGenParticlePairSlices),
   fhTrackPairsCloseToJet(in.fhTrackPairsCloseToJet),
   fhGenParticlePairsCloseToJet(in.fhGenParticlePairsCloseToJet),
-  fCard(in.fCard)
+  fCard(in.fCard),
+  fFillDeltaRSlices(in.fFillDeltaRSlices)
 {
   // Copy constructor
   
@@ -114,9 +123,12 @@ TrackPairEfficiencyHistograms& TrackPairEfficiencyHistograms::operator=(const Tr
   fhInclusiveJet = in.fhInclusiveJet;
   fhTrackPairs = in.fhTrackPairs;
   fhGenParticlePairs = in.fhGenParticlePairs;
+  fhTrackPairSlices = in.fhTrackPairSlices;
+  fhGenParticlePairSlices = in.fhGenParticlePairSlices;
   fhTrackPairsCloseToJet = in.fhTrackPairsCloseToJet;
   fhGenParticlePairsCloseToJet = in.fhGenParticlePairsCloseToJet;
   fCard = in.fCard;
+  fFillDeltaRSlices = in.fFillDeltaRSlices;
   
   return *this;
 }
@@ -141,6 +153,8 @@ TrackPairEfficiencyHistograms::~TrackPairEfficiencyHistograms(){
   delete fhInclusiveJet;
   delete fhTrackPairs;
   delete fhGenParticlePairs;
+  delete fhTrackPairSlices;
+  delete fhGenParticlePairSlices;
   delete fhTrackPairsCloseToJet;
   delete fhGenParticlePairsCloseToJet;
 }
@@ -152,6 +166,105 @@ void TrackPairEfficiencyHistograms::SetCard(ConfigurationCard* newCard){
   fCard = newCard;
 }
 
+/*
+ * Estimate for the resident memory used by the histograms. For the dense pair histograms, only the memory
+ * pages with filled bins are counted, since the rest of the allocated arrays are not mapped.
+ *
+ *   return: Memory used by the histograms in bytes
+ */
+Long64_t TrackPairEfficiencyHistograms::GetMemorySize() const{
+  Long64_t memorySize = 0;
+  memorySize += GetMemorySize(fhVertexZ);
+  memorySize += GetMemorySize(fhVertexZWeighted);
+  memorySize += GetMemorySize(fhEvents);
+  memorySize += GetMemorySize(fhCentrality);
+  memorySize += GetMemorySize(fhCentralityWeighted);
+  memorySize += GetMemorySize(fhPtHat);
+  memorySize += GetMemorySize(fhPtHatWeighted);
+  memorySize += GetMemorySize(fhTrackCuts);
+  memorySize += GetMemorySize(fhGenParticleSelections);
+  memorySize += GetMemorySize(fhTrack);
+  memorySize += GetMemorySize(fhTrackUncorrected);
+  memorySize += GetMemorySize(fhGenParticle);
+  memorySize += GetMemorySize(fhInclusiveJet);
+  if(fFillDeltaRSlices){
+    memorySize += fhTrackPairSlices->GetFilledMemorySize();
+    memorySize += fhGenParticlePairSlices->GetFilledMemorySize();
+  } else {
+    memorySize += GetMemorySize(fhTrackPairs);
+    memorySize += GetMemorySize(fhGenParticlePairs);
+  }
+  memorySize += fhTrackPairsCloseToJet->GetFilledMemorySize();
+  memorySize += fhGenParticlePairsCloseToJet->GetFilledMemorySize();
+  return memorySize;
+}
+
+/*
+ * Memory allocated for the bins of all the dense histograms
+ *
+ *   return: Size of the bin arrays of the dense histograms in bytes
+ */
+Long64_t TrackPairEfficiencyHistograms::GetDenseMemorySize() const{
+  Long64_t memorySize = fhTrackPairsCloseToJet->GetMemorySize() + fhGenParticlePairsCloseToJet->GetMemorySize();
+  if(fFillDeltaRSlices) memorySize += fhTrackPairSlices->GetMemorySize() + fhGenParticlePairSlices->GetMemorySize();
+  return memorySize;
+}
+
+/*
+ * Resident memory of the bins of all the dense histograms
+ *
+ *   return: Size of the memory pages with filled bins in the dense histograms in bytes
+ */
+Long64_t TrackPairEfficiencyHistograms::GetFilledDenseMemorySize() const{
+  Long64_t memorySize = fhTrackPairsCloseToJet->GetFilledMemorySize() + fhGenParticlePairsCloseToJet->GetFilledMemorySize();
+  if(fFillDeltaRSlices) memorySize += fhTrackPairSlices->GetFilledMemorySize() + fhGenParticlePairSlices->GetFilledMemorySize();
+  return memorySize;
+}
+
+/*
+ * Memory used by a one dimensional histogram. All the histograms have float contents and squared weights.
+ *
+ *  Arguments:
+ *   TH1 *histogram = Histogram for which the memory is calculated
+ *
+ *   return: Memory used by the histogram in bytes
+ */
+Long64_t TrackPairEfficiencyHistograms::GetMemorySize(TH1 *histogram) const{
+  return (histogram->GetNbinsX()+2) * (sizeof(Float_t)+sizeof(Double_t));
+}
+
+/*
+ * Estimate for the memory used by a sparse histogram. ROOT gives the memory used relative to a non-sparse
+ * histogram with the same binning.
+ *
+ *  Arguments:
+ *   THnSparse *histogram = Histogram for which the memory is estimated
+ *
+ *   return: Estimated memory used by the histogram in bytes
+ */
+Long64_t TrackPairEfficiencyHistograms::GetMemorySize(THnSparse *histogram) const{
+  Double_t nDenseBins = 1;
+  for(Int_t iAxis = 0; iAxis < histogram->GetNdimensions(); iAxis++){
+    nDenseBins *= histogram->GetAxis(iAxis)->GetNbins() + 2;
+  }
+  return histogram->GetSparseFractionMem() * nDenseBins * sizeof(Float_t);
+}
+
+/*
+ * Print the memory used by the histograms. For the dense pair histograms, both the resident memory of the
+ * filled bins and the memory allocated for all the bins are given.
+ */
+void TrackPairEfficiencyHistograms::PrintMemoryReport() const{
+  const Double_t bytesInMB = 1024*1024;
+  const Double_t histogramMemory = GetMemorySize() / bytesInMB;
+  const Double_t filledDenseMemory = GetFilledDenseMemorySize() / bytesInMB;
+  const Double_t allocatedDenseMemory = GetDenseMemorySize() / bytesInMB;
+  
+  cout << "Histogram memory:" << endl;
+  cout << Form("  All histograms:        %10.1f MB resident", histogramMemory) << endl;
+  cout << Form("  Dense pair histograms: %10.1f MB resident out of %.1f MB allocated", filledDenseMemory, allocatedDenseMemory) << endl;
+}
+
 /*
  * Create the necessary histograms
  */
@@ -215,6 +328,16 @@ void TrackPairEfficiencyHistograms::CreateHistograms(){
   const Double_t minWideTrackPt = wideTrackPtBins[0];
   const Double_t maxWideTrackPt = wideTrackPtBins[nWideTrackPtBins];
   
+  // Average pair eta slices for the DeltaR histograms filled directly
+  const Int_t nAverageEtaBins = fCard->GetNBin("AverageEtaBinEdges");
+  Double_t averageEtaBins[nAverageEtaBins+1];
+  for(Int_t iAverageEta = 0; iAverageEta < nAverageEtaBins+1; iAverageEta++){
+    averageEtaBins[iAverageEta] = fCard->Get("AverageEtaBinEdges",iAverageEta);
+  }
+  
+  // Fill the track pairs directly to the final DeltaR slices instead of the full pair histograms
+  fFillDeltaRSlices = (fCard->Get("FillDeltaRSlices") == 1);
+  
   // Bins for the pT hat histogram
   const Int_t nPtHatBins = fCard->GetNBin("PtHatBinEdges");
   Double_t ptHatBins[nPtHatBins+1];
@@ -357,7 +480,7 @@ void TrackPairEfficiencyHistograms::CreateHistograms(){
   // Set custom centrality bins for histograms
   fhInclusiveJet->SetBinEdges(3,wideCentralityBins);
   
-  // ======== THnSparses for track pairs ========
+  // ======== THnSparses for track pairs, or dense histograms in the final DeltaR slices ========
   
   // Axis 0 for the track pair histogram: deltaR between the two tracks
   nBinsTrackPair[0] = nDeltaRBinsEEC;         // nBins for deltaR between the tracks
@@ -389,25 +512,62 @@ void TrackPairEfficiencyHistograms::CreateHistograms(){
   lowBinBorderTrackPair[5] = minCentrality;  // low bin border for centrality
   highBinBorderTrackPair[5] = maxCentrality; // high bin border for centrality
   
-  // Create the histograms for tracks and uncorrected tracks using the above binning information
-  fhTrackPairs = new THnSparseF("trackPairs","trackPairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhTrackPairs->Sumw2();
-  fhGenParticlePairs = new THnSparseF("genParticlePairs","genParticlePairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhGenParticlePairs->Sumw2();
-
-  // Set custom deltaR bins for histograms
-  fhTrackPairs->SetBinEdges(0,deltaRBinsEEC);
-  fhGenParticlePairs->SetBinEdges(0,deltaRBinsEEC);
-  
-  // Set custom track pT bins for histograms
-  fhTrackPairs->SetBinEdges(1,wideTrackPtBins);
-  fhGenParticlePairs->SetBinEdges(1,wideTrackPtBins);
-  fhTrackPairs->SetBinEdges(2,wideTrackPtBins);
-  fhGenParticlePairs->SetBinEdges(2,wideTrackPtBins);
+  // When filling the DeltaR slices directly, phi is integrated over and eta only has the slice bins
+  if(fFillDeltaRSlices){
+    nBinsTrackPair[3] = 1;
+    nBinsTrackPair[4] = nAverageEtaBins;
+    lowBinBorderTrackPair[4] = averageEtaBins[0];
+    highBinBorderTrackPair[4] = averageEtaBins[nAverageEtaBins];
+  }
   
-  // Set custom centrality bins for histograms
-  fhTrackPairs->SetBinEdges(5,wideCentralityBins);
-  fhGenParticlePairs->SetBinEdges(5,wideCentralityBins);
+  // The full binning has too many bins to keep all of them in memory, so it is only used with THnSparses.
+  // The slice binning is small, and the pairs are filled to dense histograms that are written as DeltaR slices.
+  if(fFillDeltaRSlices){
+    
+    // Create the histograms for track pairs in slices using the above binning information
+    fhTrackPairSlices = new DenseHistogram("trackPairs","trackPairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhTrackPairSlices->Sumw2();
+    fhGenParticlePairSlices = new DenseHistogram("genParticlePairs","genParticlePairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhGenParticlePairSlices->Sumw2();
+    
+    // Set custom deltaR bins for histograms
+    fhTrackPairSlices->SetLogarithmicBinEdges(0,deltaRBinsEEC,binnerShift);
+    fhGenParticlePairSlices->SetLogarithmicBinEdges(0,deltaRBinsEEC,binnerShift);
+    
+    // Set the average eta slices for histograms
+    fhTrackPairSlices->SetBinEdges(4,averageEtaBins);
+    fhGenParticlePairSlices->SetBinEdges(4,averageEtaBins);
+    
+    // Set custom track pT bins for histograms
+    fhTrackPairSlices->SetBinEdges(1,wideTrackPtBins);
+    fhGenParticlePairSlices->SetBinEdges(1,wideTrackPtBins);
+    fhTrackPairSlices->SetBinEdges(2,wideTrackPtBins);
+    fhGenParticlePairSlices->SetBinEdges(2,wideTrackPtBins);
+    
+    // Set custom centrality bins for histograms
+    fhTrackPairSlices->SetBinEdges(5,wideCentralityBins);
+    fhGenParticlePairSlices->SetBinEdges(5,wideCentralityBins);
+    
+  } else {
+    
+    // Create the histograms for track pairs using the above binning information
+    fhTrackPairs = new THnSparseF("trackPairs","trackPairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhTrackPairs->Sumw2();
+    fhGenParticlePairs = new THnSparseF("genParticlePairs","genParticlePairs",nAxesTrackPair,nBinsTrackPair,lowBinBorderTrackPair,highBinBorderTrackPair); fhGenParticlePairs->Sumw2();
+    
+    // Set custom deltaR bins for histograms
+    fhTrackPairs->SetBinEdges(0,deltaRBinsEEC);
+    fhGenParticlePairs->SetBinEdges(0,deltaRBinsEEC);
+    
+    // Set custom track pT bins for histograms
+    fhTrackPairs->SetBinEdges(1,wideTrackPtBins);
+    fhGenParticlePairs->SetBinEdges(1,wideTrackPtBins);
+    fhTrackPairs->SetBinEdges(2,wideTrackPtBins);
+    fhGenParticlePairs->SetBinEdges(2,wideTrackPtBins);
+    
+    // Set custom centrality bins for histograms
+    fhTrackPairs->SetBinEdges(5,wideCentralityBins);
+    fhGenParticlePairs->SetBinEdges(5,wideCentralityBins);
+  }
 
-  // ======== THnSparses for track pairs close to jets ========
+  // ======== Dense histograms for track pairs close to jets, written as THnSparses ========
   
   // Axis 0 for the track pair close to jets histogram: deltaR between the two tracks
   nBinsTrackPairCloseToJet[0] = nDeltaRBinsEEC;         // nBins for deltaR between the tracks
@@ -442,12 +602,12 @@ void TrackPairEfficiencyHistograms::CreateHistograms(){
   
   
   // Create the histograms for tracks and uncorrected tracks using the above binning information
-  fhTrackPairsCloseToJet = new THnSparseF("trackPairsCloseToJet", "trackPairsCloseToJet", nAxesTrackPairCloseToJet, nBinsTrackPairCloseToJet, lowBinBorderTrackPairCloseToJet, highBinBorderTrackPairCloseToJet); fhTrackPairsCloseToJet->Sumw2();
-  fhGenParticlePairsCloseToJet = new THnSparseF("genParticlePairsCloseToJet","genParticlePairsCloseToJet", nAxesTrackPairCloseToJet, nBinsTrackPairCloseToJet,lowBinBorderTrackPairCloseToJet, highBinBorderTrackPairCloseToJet); fhGenParticlePairsCloseToJet->Sumw2();
+  fhTrackPairsCloseToJet = new DenseHistogram("trackPairsCloseToJet", "trackPairsCloseToJet", nAxesTrackPairCloseToJet, nBinsTrackPairCloseToJet, lowBinBorderTrackPairCloseToJet, highBinBorderTrackPairCloseToJet); fhTrackPairsCloseToJet->Sumw2();
+  fhGenParticlePairsCloseToJet = new DenseHistogram("genParticlePairsCloseToJet","genParticlePairsCloseToJet", nAxesTrackPairCloseToJet, nBinsTrackPairCloseToJet,lowBinBorderTrackPairCloseToJet, highBinBorderTrackPairCloseToJet); fhGenParticlePairsCloseToJet->Sumw2();
 
   // Set custom deltaR bins for histograms
-  fhTrackPairsCloseToJet->SetBinEdges(0,deltaRBinsEEC);
-  fhGenParticlePairsCloseToJet->SetBinEdges(0,deltaRBinsEEC);
+  fhTrackPairsCloseToJet->SetLogarithmicBinEdges(0,deltaRBinsEEC,binnerShift);
+  fhGenParticlePairsCloseToJet->SetLogarithmicBinEdges(0,deltaRBinsEEC,binnerShift);
   
   // Set custom track pT bins for histograms
   fhTrackPairsCloseToJet->SetBinEdges(1,wideTrackPtBins);
@@ -462,6 +622,13 @@ void TrackPairEfficiencyHistograms::CreateHistograms(){
   // Set custom centrality bins for histograms
   fhTrackPairsCloseToJet->SetBinEdges(5,wideCentralityBins);
   fhGenParticlePairsCloseToJet->SetBinEdges(5,wideCentralityBins);
+  
+  // All the bins of the dense histograms are kept in memory. The arrays are not touched before filling,
+  // so stop here if the binning given in the card would need more memory than the budget for them.
+  if(GetDenseMemorySize() > kDenseHistogramMemoryLimit*1024*1024){
+    cout << "Error! The dense pair histograms need " << GetDenseMemorySize()/(1024*1024) << " MB, but only " << kDenseHistogramMemoryLimit << " MB are allowed. Use fewer bins in the card." << endl;
+    assert(0);
+  }
 }
 
 /*
@@ -483,13 +650,113 @@ void TrackPairEfficiencyHistograms::Write() const{
   fhTrackUncorrected->Write();
   fhGenParticle->Write();
   fhInclusiveJet->Write();
-  fhTrackPairs->Write();
-  fhGenParticlePairs->Write();
+  if(fFillDeltaRSlices){
+    WriteDeltaRSlices(fhTrackPairSlices);
+    WriteDeltaRSlices(fhGenParticlePairSlices);
+  } else {
+    fhTrackPairs->Write();
+    fhGenParticlePairs->Write();
+  }
   fhTrackPairsCloseToJet->Write();
   fhGenParticlePairsCloseToJet->Write();
   
 }
 
+/*
+ * Write the DeltaR distributions in all centrality, trigger pT, associated pT and average eta slices of a pair
+ * histogram filled in the slice mode. The indices in the histogram names are the bins of this histogram, and
+ * the last average eta index is the distribution integrated over eta. The histograms are normalized to the bin
+ * width in the same way as the projections in TrackPairEfficiencyHistogramManager.
+ *
+ * An empty THnSparseF with the binning of the pair histogram is written to the same directory with the name
+ * <pairs>Binning. TrackPairEfficiencyHistogramManager finds the slices belonging to the bins given in
+ * projectTrackPairEfficiencyHistograms.C from it, and sums them in the same way as the projection would.
+ *
+ *  Arguments:
+ *   const DenseHistogram *pairHistogram = Track pair histogram with the axes [deltaR][trigger pT][associated pT][phi][average eta][cent]
+ */
+void TrackPairEfficiencyHistograms::WriteDeltaRSlices(const DenseHistogram *pairHistogram) const{
+  
+  const char *histogramName = pairHistogram->GetName();
+  const TAxis *deltaRAxis = pairHistogram->GetAxis(0);
+  const Int_t nDeltaRBins = deltaRAxis->GetNbins();
+  const Int_t nTrackPairPtBins = pairHistogram->GetAxis(1)->GetNbins();
+  const Int_t nPhiBins = pairHistogram->GetAxis(3)->GetNbins();
+  const Int_t nAverageEtaBins = pairHistogram->GetAxis(4)->GetNbins();
+  const Int_t nCentralityBins = pairHistogram->GetAxis(5)->GetNbins();
+  
+  // Create a directory for the histograms if it does not already exist
+  if(!gDirectory->GetDirectory(histogramName)) gDirectory->mkdir(histogramName);
+  gDirectory->cd(histogramName);
+  
+  // Write the binning of the slices for the projection code
+  THnSparseF *binningHistogram = pairHistogram->CreateEmptySparse();
+  binningHistogram->Write(Form("%sBinning", histogramName));
+  delete binningHistogram;
+  
+  TString histogramNamer;
+  TH1D *deltaRHistogram;
+  Int_t binIndex[6];
+  Int_t firstEtaBin, lastEtaBin;
+  Long64_t bin;
+  Double_t binContent, binError2;
+  
+  for(Int_t iCentrality = 0; iCentrality < nCentralityBins; iCentrality++){
+    binIndex[5] = iCentrality+1;
+    for(Int_t iTriggerPt = 0; iTriggerPt < nTrackPairPtBins; iTriggerPt++){
+      binIndex[1] = iTriggerPt+1;
+      for(Int_t iAssociatedPt = 0; iAssociatedPt <= iTriggerPt; iAssociatedPt++){
+        binIndex[2] = iAssociatedPt+1;
+        for(Int_t iAverageEta = 0; iAverageEta <= nAverageEtaBins; iAverageEta++){
+          
+          if(iAverageEta == nAverageEtaBins){
+            // DeltaR histograms without eta selection include all the eta bins
+            histogramNamer = Form("%sDeltaR_C%dT%dA%d", histogramName, iCentrality, iTriggerPt, iAssociatedPt);
+            firstEtaBin = 0;
+            lastEtaBin = nAverageEtaBins+1;
+          } else {
+            // DeltaR histograms in average eta bins
+            histogramNamer = Form("%sDeltaR_C%dT%dA%dE%d", histogramName, iCentrality, iTriggerPt, iAssociatedPt, iAverageEta);
+            firstEtaBin = iAverageEta+1;
+            lastEtaBin = iAverageEta+1;
+          }
+          
+          deltaRHistogram = new TH1D(histogramNamer.Data(), histogramNamer.Data(), nDeltaRBins, deltaRAxis->GetXbins()->GetArray());
+          deltaRHistogram->SetDirectory(0);
+          deltaRHistogram->Sumw2();
+          
+          // Sum the phi and eta bins for each deltaR bin, including the underflow and overflow bins
+          for(Int_t iDeltaR = 0; iDeltaR <= nDeltaRBins+1; iDeltaR++){
+            binIndex[0] = iDeltaR;
+            binContent = 0;
+            binError2 = 0;
+            for(Int_t iPhi = 0; iPhi <= nPhiBins+1; iPhi++){
+              binIndex[3] = iPhi;
+              for(Int_t iEta = firstEtaBin; iEta <= lastEtaBin; iEta++){
+                binIndex[4] = iEta;
+                bin = pairHistogram->GetBin(binIndex);
+                binContent += pairHistogram->GetBinContent(bin);
+                binError2 += pairHistogram->GetBinError2(bin);
+              }
+            }
+            deltaRHistogram->SetBinContent(iDeltaR, binContent);
+            deltaRHistogram->SetBinError(iDeltaR, TMath::Sqrt(binError2));
+          }
+          
+          // Normalize to the bin width as is done for the projected histograms
+          deltaRHistogram->Scale(1.0,"width");
+          deltaRHistogram->Write(histogramNamer.Data());
+          delete deltaRHistogram;
+          
+        } // Average eta loop
+      } // Associated pT loop
+    } // Trigger pT loop
+  } // Centrality loop
+  
+  // Return back to main directory
+  gDirectory->cd("../");
+}
+
 /*
  * Write the histograms to a given file
  */
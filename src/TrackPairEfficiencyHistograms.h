@@ -10,6 +10,7 @@
 
 // Own includes
 #include "ConfigurationCard.h"
+#include "DenseHistogram.h"
 
 class TrackPairEfficiencyHistograms{
   
@@ -33,6 +34,8 @@ public:
   void Write() const;                           // Write the histograms to a file that is opened somewhere else
   void Write(TString outputFileName) const;     // Write the histograms to a file
   void SetCard(ConfigurationCard* newCard);     // Set a new configuration card for the histogram class
+  Long64_t GetMemorySize() const;               // Estimate for the resident memory used by the histograms in bytes
+  void PrintMemoryReport() const;               // Print the resident and allocated histogram memory
   
   // Histograms defined public to allow easier access to them. Should not be abused
   // Notation in comments: l = leading jet, s = subleading jet, inc - inclusive jet, uc = uncorrected, ptw = pT weighted
@@ -49,14 +52,24 @@ public:
   THnSparseF* fhTrackUncorrected;  // Track histogram for uncorrected tracks. Axes: [uc pT][uc phi][uc eta][cent]
   THnSparseF* fhGenParticle;       // Generator level particle histogram. Axes: [pT][phi][eta][cent]
   THnSparseF* fhInclusiveJet;      // Inclusive jet information. Axes: [jet pT][jet phi][jet eta][cent][reco/gen][trigger]
-  THnSparseF* fhTrackPairs;        // Track pair histogram
-  THnSparseF* fhGenParticlePairs;  // Generator level particle pair histogram
-  THnSparseF* fhTrackPairsCloseToJet;        // Track pair histogram for particles close to a jet
-  THnSparseF* fhGenParticlePairsCloseToJet;  // Generator level particle pair histogram for particles close to a jet
+  THnSparseF* fhTrackPairs;        // Track pair histogram. Axes: [deltaR][trigger pT][associated pT][average phi][average eta][cent]
+  THnSparseF* fhGenParticlePairs;  // Generator level particle pair histogram. Axes as for track pairs.
+  DenseHistogram* fhTrackPairSlices;       // Track pairs in the final DeltaR slices. Axes: [deltaR][trigger pT][associated pT][phi][average eta slice][cent]
+  DenseHistogram* fhGenParticlePairSlices; // Generator level particle pairs in the final DeltaR slices. Axes as for track pair slices.
+  DenseHistogram* fhTrackPairsCloseToJet;    // Track pair histogram for particles close to a jet
+  DenseHistogram* fhGenParticlePairsCloseToJet; // Generator level particle pair histogram for particles close to a jet
   
 private:
   
+  void WriteDeltaRSlices(const DenseHistogram *pairHistogram) const; // Write the DeltaR histograms in the final slices of a pair histogram
+  Long64_t GetMemorySize(TH1 *histogram) const;            // Memory used by a one dimensional histogram in bytes
+  Long64_t GetMemorySize(THnSparse *histogram) const;      // Estimate for the memory used by a sparse histogram in bytes
+  Long64_t GetDenseMemorySize() const;                     // Memory allocated for the bins of all the dense histograms in bytes
+  Long64_t GetFilledDenseMemorySize() const;               // Resident memory of the bins of all the dense histograms in bytes
+  
   ConfigurationCard* fCard;    // Card for binning info
+  Bool_t fFillDeltaRSlices;    // Fill the track pairs directly to DeltaR histograms in the final slices instead of full pair histograms
+  const Double_t kDenseHistogramMemoryLimit = 200; // Maximum memory for all the bins of the dense histograms in MB
   const TString kEventTypeStrings[knEventTypes] = {"All", "PrimVertex", "HfCoin2Th4", "ClustCompt", "BeamScrape", "CaloJet", "v_{z} cut"}; // Strings corresponding to event types
   const TString kTrackCutStrings[knTrackCuts] = {"All", "p_{T} cut", "#eta cut", "HighPurity", "p_{T} error", "vertexDist", "caloSignal", "RecoQuality"}; // String corresponding to track cuts
   const TString kGenParticleSelectionStrings[knTrackCuts] = {"All", "MC Charge", "MC sube", "p_{T} cut", "#eta cut"}; // String corresponding to generator level particle selections
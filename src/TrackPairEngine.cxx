@@ -0,0 +1,237 @@
+// Implementation of the track pair enumeration
+
+// Own includes
+#include "TrackPairEngine.h"
+
+/*
+ * Default constructor
+ */
+TrackPairEngine::TrackPairEngine() :
+  fTriggerEtaCut(0),
+  fCutBadPhiRegionTrigger(false),
+  fGrid(0.8),
+  fKernel(0.8),
+  fTracks(0),
+  fMembers(0),
+  fnMembers(0),
+  fTriggerMask(),
+  fCurrentCell(0),
+  fCurrentPosition(-1),
+  fTrigger(-1),
+  fnPairs(0)
+{
+  // Default constructor
+}
+
+/*
+ * Custom constructor
+ *
+ *  Arguments:
+ *   const Double_t maxDeltaR = Maximum DeltaR for the accepted pairs
+ */
+TrackPairEngine::TrackPairEngine(const Double_t maxDeltaR) :
+  fTriggerEtaCut(0),
+  fCutBadPhiRegionTrigger(false),
+  fGrid(maxDeltaR),
+  fKernel(maxDeltaR),
+  fTracks(0),
+  fMembers(0),
+  fnMembers(0),
+  fTriggerMask(),
+  fCurrentCell(0),
+  fCurrentPosition(-1),
+  fTrigger(-1),
+  fnPairs(0)
+{
+  // Custom constructor
+}
+
+/*
+ * Copy constructor. The tracks are not copied, since the table might not live as long as the copy.
+ */
+TrackPairEngine::TrackPairEngine(const TrackPairEngine& in) :
+  fTriggerEtaCut(in.fTriggerEtaCut),
+  fCutBadPhiRegionTrigger(in.fCutBadPhiRegionTrigger),
+  fGrid(in.fGrid),
+  fKernel(in.fKernel),
+  fTracks(0),
+  fMembers(0),
+  fnMembers(0),
+  fTriggerMask(),
+  fCurrentCell(0),
+  fCurrentPosition(-1),
+  fTrigger(-1),
+  fnPairs(0)
+{
+  // Copy constructor
+}
+
+/*
+ * Destructor
+ */
+TrackPairEngine::~TrackPairEngine(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+TrackPairEngine& TrackPairEngine::operator=(const TrackPairEngine& in){
+  if(&in == this) return *this;
+
+  fTriggerEtaCut = in.fTriggerEtaCut;
+  fCutBadPhiRegionTrigger = in.fCutBadPhiRegionTrigger;
+  fGrid = in.fGrid;
+  fKernel = in.fKernel;
+  fTracks = 0;
+  fMembers = 0;
+  fnMembers = 0;
+  fTriggerMask.clear();
+  fCurrentCell = 0;
+  fCurrentPosition = -1;
+  fTrigger = -1;
+  fnPairs = 0;
+
+  return *this;
+}
+
+/*
+ * Setter for the cuts applied to the trigger tracks
+ *
+ *  Arguments:
+ *   const Double_t triggerEtaCut = Maximum absolute eta for the trigger tracks
+ *   const Bool_t cutBadPhiRegion = True: Do not accept trigger tracks from the phi region with bad tracker performance
+ */
+void TrackPairEngine::SetTriggerCuts(const Double_t triggerEtaCut, const Bool_t cutBadPhiRegion){
+  fTriggerEtaCut = triggerEtaCut;
+  fCutBadPhiRegionTrigger = cutBadPhiRegion;
+}
+
+/*
+ * Prepare to go through the pairs of all the tracks in the table. The tracks are sorted to the eta-phi grid.
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &tracks = Track table sorted by decreasing pT. Must not be changed while the pairs are searched.
+ *   const Bool_t applyTriggerCuts = True: Only the tracks passing the trigger cuts are used as triggers
+ */
+void TrackPairEngine::SetTracks(const SelectedTrackBuffer &tracks, const Bool_t applyTriggerCuts){
+  fTracks = &tracks;
+  fMembers = 0;
+  fnMembers = 0;
+
+  fGrid.Clear();
+  for(Int_t iTrack = 0; iTrack < tracks.GetNTracks(); iTrack++){
+    fGrid.AddTrack(tracks.GetEta(iTrack), tracks.GetPhi(iTrack));
+  }
+  fGrid.Build();
+
+  FillTriggerMask(applyTriggerCuts);
+  fCurrentCell = 0;
+  fCurrentPosition = -1;
+  fTrigger = -1;
+  fnPairs = 0;
+}
+
+/*
+ * Prepare to go through the pairs of a subset of the tracks. All the pairs in the subset are checked, so this
+ * is meant for small subsets, like the tracks inside one jet cone.
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &tracks = Track table sorted by decreasing pT. Must not be changed while the pairs are searched.
+ *   const std::vector<Int_t> &members = Indices of the tracks in the subset in increasing order. Must not be changed while the pairs are searched.
+ *   const Bool_t applyTriggerCuts = True: Only the tracks passing the trigger cuts are used as triggers
+ */
+void TrackPairEngine::SetTracks(const SelectedTrackBuffer &tracks, const std::vector<Int_t> &members, const Bool_t applyTriggerCuts){
+  fTracks = &tracks;
+  fMembers = members.data();
+  fnMembers = members.size();
+
+  FillTriggerMask(applyTriggerCuts);
+  fCurrentCell = 0;
+  fCurrentPosition = -1;
+  fTrigger = -1;
+  fnPairs = 0;
+}
+
+/*
+ * Find the accepted pairs for the next trigger track that has any. The pairs are then read with the getters.
+ *
+ *   return: True if pairs were found, false if all the triggers are done
+ */
+Bool_t TrackPairEngine::FindNextPairs(){
+
+  while(NextTrigger()){
+
+    if(fMembers){
+      // In a subset, all the following members are partner candidates
+      fnPairs = fKernel.FindClosePairs(*fTracks, fTrigger, fMembers + fCurrentPosition + 1, fnMembers - fCurrentPosition - 1);
+    } else {
+      // In the full event, the partner candidates are the tracks with larger index in the surrounding cells
+      fnPairs = fKernel.FindClosePairs(*fTracks, fTrigger, fGrid.FindPairCandidates(fTrigger));
+    }
+
+    if(fnPairs > 0) return true;
+  }
+
+  fnPairs = 0;
+  return false;
+}
+
+// Getter for the name of the implementation used for the pair preselection
+const char* TrackPairEngine::GetImplementationName() const{
+  return fKernel.GetImplementationName();
+}
+
+/*
+ * Evaluate the trigger cuts for all the tracks in the table. The loop has no branches, such that it can be vectorized.
+ *
+ *  Arguments:
+ *   const Bool_t applyTriggerCuts = False: All the tracks pass
+ */
+void TrackPairEngine::FillTriggerMask(const Bool_t applyTriggerCuts){
+
+  const Int_t nTracks = fTracks->GetNTracks();
+  const Float_t *eta = fTracks->GetEtaArray();
+  const Float_t *phi = fTracks->GetPhiArray();
+  fTriggerMask.resize(nTracks);
+
+  const Bool_t cutEta = applyTriggerCuts;
+  const Bool_t cutPhi = applyTriggerCuts && fCutBadPhiRegionTrigger;
+  Double_t trackPhi;
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    trackPhi = phi[iTrack];
+    fTriggerMask[iTrack] = (!cutEta | (TMath::Abs((Double_t)eta[iTrack]) <= fTriggerEtaCut)) & !(cutPhi & (trackPhi > -0.1) & (trackPhi < 1.2));
+  }
+}
+
+/*
+ * Move to the next trigger track passing the trigger cuts. In the full event, the triggers are gone through
+ * cell by cell, and in increasing index order inside each cell.
+ *
+ *   return: True if a trigger was found, false if all the triggers are done
+ */
+Bool_t TrackPairEngine::NextTrigger(){
+
+  if(fTracks == 0) return false;
+
+  // Subset of tracks
+  if(fMembers){
+    while(++fCurrentPosition < fnMembers){
+      fTrigger = fMembers[fCurrentPosition];
+      if(fTriggerMask[fTrigger]) return true;
+    }
+    fCurrentPosition = fnMembers;
+    return false;
+  }
+
+  // Full event
+  const Int_t nCells = fGrid.GetNCells();
+  for(; fCurrentCell < nCells; fCurrentCell++){
+    while(++fCurrentPosition < fGrid.GetNCellTracks(fCurrentCell)){
+      fTrigger = fGrid.GetCellTracks(fCurrentCell)[fCurrentPosition];
+      if(fTriggerMask[fTrigger]) return true;
+    }
+    fCurrentPosition = -1;
+  }
+  return false;
+}
@@ -0,0 +1,85 @@
+// Class for going through all the track pairs closer than the maximum DeltaR in one set of tracks
+//
+//===========================================================
+// TrackPairEngine.h
+//
+// The same pair enumeration is used for the inclusive track pairs and for the track pairs close to jets.
+// The tracks are given in a table sorted by decreasing pT, such that the trigger track with the lower index
+// in a pair is always the one with higher pT. Only the upper triangle of the pair matrix is visited.
+//
+// For a full event, the tracks are sorted to an eta-phi grid with cells at least as large as the maximum
+// DeltaR. The cells are used as tiles of the pair matrix: all the trigger tracks in one cell are paired
+// before moving to the next cell, such that the partners are only read from the nine surrounding cells.
+// For central PbPb events this working set fits in the L1 cache. For a small subset of tracks, like the
+// tracks inside one jet cone, all the pairs of the subset are checked directly without a grid.
+//
+// The trigger track cuts are evaluated once for each track when the tracks are given, and the triggers
+// failing the cuts are skipped without looking at their partners.
+//===========================================================
+
+#ifndef TRACKPAIRENGINE_H
+#define TRACKPAIRENGINE_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <assert.h>
+
+// Root includes
+#include <TMath.h>
+
+// Own includes
+#include "SelectedTrackBuffer.h"
+#include "TrackPairGrid.h"
+#include "TrackPairKernel.h"
+
+using namespace std;
+
+class TrackPairEngine{
+
+public:
+
+  // Constructors and destructor
+  TrackPairEngine();                                    // Default constructor
+  TrackPairEngine(const Double_t maxDeltaR);            // Custom constructor
+  TrackPairEngine(const TrackPairEngine& in);           // Copy constructor
+  ~TrackPairEngine();                                   // Destructor
+  TrackPairEngine& operator=(const TrackPairEngine& obj); // Equal sign operator
+
+  // Setters
+  void SetTriggerCuts(const Double_t triggerEtaCut, const Bool_t cutBadPhiRegion); // Setter for the cuts applied to the trigger tracks
+
+  // Methods
+  void SetTracks(const SelectedTrackBuffer &tracks, const Bool_t applyTriggerCuts); // Prepare to go through the pairs of all the tracks in the table
+  void SetTracks(const SelectedTrackBuffer &tracks, const std::vector<Int_t> &members, const Bool_t applyTriggerCuts); // Prepare to go through the pairs of a subset of the tracks
+  Bool_t FindNextPairs();                        // Find the accepted pairs for the next trigger track
+  const char* GetImplementationName() const;     // Getter for the name of the implementation used for the pair preselection
+
+  // Getters for the pairs of the current trigger. Defined here, since these are called in the pair loops.
+  Int_t GetTrigger() const{return fTrigger;}                                     // Getter for the index of the current trigger track
+  Int_t GetNPairs() const{return fnPairs;}                                       // Getter for the number of accepted pairs for the current trigger
+  Int_t GetPartner(const Int_t iPair) const{return fKernel.GetPartner(iPair);}         // Getter for the index of the partner track
+  Double_t GetDeltaR(const Int_t iPair) const{return fKernel.GetDeltaR(iPair);}        // Getter for DeltaR between the tracks
+  Double_t GetAveragePhi(const Int_t iPair) const{return fKernel.GetAveragePhi(iPair);} // Getter for the average phi of the tracks
+
+private:
+
+  void FillTriggerMask(const Bool_t applyTriggerCuts); // Evaluate the trigger cuts for all the tracks in the table
+  Bool_t NextTrigger();                                // Move to the next trigger track passing the trigger cuts
+
+  Double_t fTriggerEtaCut;                // Maximum absolute eta for the trigger tracks
+  Bool_t fCutBadPhiRegionTrigger;         // Remove the trigger tracks from the phi region with bad tracker performance
+  TrackPairGrid fGrid;                    // Eta-phi grid for the full event. The cells are the tiles of the pair matrix.
+  TrackPairKernel fKernel;                // Kernel selecting the pairs closer than the maximum DeltaR
+  const SelectedTrackBuffer *fTracks;     // Track table from which the pairs are searched
+  const Int_t *fMembers;                  // Indices of the tracks in the subset. Null when going through a full event.
+  Int_t fnMembers;                        // Number of tracks in the subset
+  std::vector<UChar_t> fTriggerMask;      // Flag for each track in the table telling if it passes the trigger cuts
+  Int_t fCurrentCell;                     // Cell of the current trigger track
+  Int_t fCurrentPosition;                 // Position of the current trigger track in the cell or in the subset
+  Int_t fTrigger;                         // Index of the current trigger track in the table
+  Int_t fnPairs;                          // Number of accepted pairs for the current trigger track
+
+};
+
+#endif
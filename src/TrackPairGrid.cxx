@@ -0,0 +1,272 @@
+// Implementation of the eta-phi grid for track pairs
+
+// Own includes
+#include "TrackPairGrid.h"
+
+/*
+ * Default constructor
+ */
+TrackPairGrid::TrackPairGrid() :
+  fMaxDeltaR(0.8),
+  fnEtaCells(0),
+  fnPhiCells(0),
+  fMinEta(0),
+  fEtaCellSize(0),
+  fPhiCellSize(0),
+  fTrackEta(),
+  fTrackPhi(),
+  fTrackCell(),
+  fCellStart(),
+  fCellTracks(),
+  fPairCandidates()
+{
+  // Default constructor
+}
+
+/*
+ * Custom constructor
+ *
+ *  Arguments:
+ *   const Double_t maxDeltaR = Maximum distance of the pairs that need to be found
+ */
+TrackPairGrid::TrackPairGrid(const Double_t maxDeltaR) :
+  fMaxDeltaR(maxDeltaR),
+  fnEtaCells(0),
+  fnPhiCells(0),
+  fMinEta(0),
+  fEtaCellSize(0),
+  fPhiCellSize(0),
+  fTrackEta(),
+  fTrackPhi(),
+  fTrackCell(),
+  fCellStart(),
+  fCellTracks(),
+  fPairCandidates()
+{
+  // Custom constructor
+  if(fMaxDeltaR <= 0){
+    cout << "Error! The maximum pair distance must be positive. Now it is " << fMaxDeltaR << endl;
+    assert(0);
+  }
+}
+
+/*
+ * Copy constructor
+ */
+TrackPairGrid::TrackPairGrid(const TrackPairGrid& in) :
+  fMaxDeltaR(in.fMaxDeltaR),
+  fnEtaCells(in.fnEtaCells),
+  fnPhiCells(in.fnPhiCells),
+  fMinEta(in.fMinEta),
+  fEtaCellSize(in.fEtaCellSize),
+  fPhiCellSize(in.fPhiCellSize),
+  fTrackEta(in.fTrackEta),
+  fTrackPhi(in.fTrackPhi),
+  fTrackCell(in.fTrackCell),
+  fCellStart(in.fCellStart),
+  fCellTracks(in.fCellTracks),
+  fPairCandidates()
+{
+  // Copy constructor
+}
+
+/*
+ * Destructor
+ */
+TrackPairGrid::~TrackPairGrid(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+TrackPairGrid& TrackPairGrid::operator=(const TrackPairGrid& in){
+  if(&in == this) return *this;
+
+  fMaxDeltaR = in.fMaxDeltaR;
+  fnEtaCells = in.fnEtaCells;
+  fnPhiCells = in.fnPhiCells;
+  fMinEta = in.fMinEta;
+  fEtaCellSize = in.fEtaCellSize;
+  fPhiCellSize = in.fPhiCellSize;
+  fTrackEta = in.fTrackEta;
+  fTrackPhi = in.fTrackPhi;
+  fTrackCell = in.fTrackCell;
+  fCellStart = in.fCellStart;
+  fCellTracks = in.fCellTracks;
+  fPairCandidates.clear();
+
+  return *this;
+}
+
+/*
+ * Remove all the tracks from the grid. The allocated memory is kept for the next event.
+ */
+void TrackPairGrid::Clear(){
+  fTrackEta.clear();
+  fTrackPhi.clear();
+  fTrackCell.clear();
+  fCellTracks.clear();
+  fnEtaCells = 0;
+  fnPhiCells = 0;
+}
+
+/*
+ * Add a track to the grid. The track index is the number of tracks added before it.
+ *
+ *  Arguments:
+ *   const Double_t eta = Eta of the track
+ *   const Double_t phi = Phi of the track
+ */
+void TrackPairGrid::AddTrack(const Double_t eta, const Double_t phi){
+  fTrackEta.push_back(eta);
+  fTrackPhi.push_back(phi);
+}
+
+/*
+ * Sort the added tracks to the cells. The grid covers the eta range of the added tracks.
+ */
+void TrackPairGrid::Build(){
+
+  const Int_t nTracks = fTrackEta.size();
+  fTrackCell.resize(nTracks);
+  fCellTracks.resize(nTracks);
+  if(nTracks == 0) return;
+
+  // The cells are at least fMaxDeltaR wide, such that all close pairs are in the same or adjacent cells
+  fMinEta = *std::min_element(fTrackEta.begin(), fTrackEta.end());
+  const Double_t etaRange = *std::max_element(fTrackEta.begin(), fTrackEta.end()) - fMinEta;
+  fnEtaCells = std::max(1, (Int_t)(etaRange / fMaxDeltaR));
+  fEtaCellSize = etaRange > 0 ? etaRange / fnEtaCells : fMaxDeltaR;
+  fnPhiCells = std::max(1, (Int_t)(2*TMath::Pi() / fMaxDeltaR));
+  fPhiCellSize = 2*TMath::Pi() / fnPhiCells;
+
+  // Count the tracks in each cell
+  const Int_t nCells = fnEtaCells*fnPhiCells;
+  fCellStart.assign(nCells+1, 0);
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    fTrackCell[iTrack] = GetEtaCell(fTrackEta[iTrack])*fnPhiCells + GetPhiCell(fTrackPhi[iTrack]);
+    fCellStart[fTrackCell[iTrack]+1]++;
+  }
+  for(Int_t iCell = 0; iCell < nCells; iCell++){
+    fCellStart[iCell+1] += fCellStart[iCell];
+  }
+
+  // Fill the track indices to the cells. The tracks are added in increasing index order.
+  fPairCandidates.assign(fCellStart.begin(), fCellStart.end()-1);
+  for(Int_t iTrack = 0; iTrack < nTracks; iTrack++){
+    fCellTracks[fPairCandidates[fTrackCell[iTrack]]++] = iTrack;
+  }
+  fPairCandidates.clear();
+}
+
+/*
+ * Find the pair candidates for a track. These are the tracks with larger index in the same or adjacent cells.
+ *
+ *  Arguments:
+ *   const Int_t iTrack = Index of the track for which the pair candidates are searched
+ *
+ *   return: Indices of the pair candidates, in increasing order within each cell. Valid until the next call.
+ */
+const std::vector<Int_t>& TrackPairGrid::FindPairCandidates(const Int_t iTrack){
+  fPairCandidates.clear();
+  CollectNeighbourCells(fTrackCell[iTrack] / fnPhiCells, fTrackCell[iTrack] % fnPhiCells, iTrack+1);
+  return fPairCandidates;
+}
+
+/*
+ * Find the tracks that can be closer than the maximum distance to a given direction. These are the tracks in the
+ * same or adjacent cells as the direction. The exact distance needs to be checked for the returned tracks.
+ *
+ *  Arguments:
+ *   const Double_t eta = Eta of the direction
+ *   const Double_t phi = Phi of the direction
+ *
+ *   return: Indices of the candidate tracks in increasing order. Valid until the next call.
+ */
+const std::vector<Int_t>& TrackPairGrid::FindConeCandidates(const Double_t eta, const Double_t phi){
+
+  fPairCandidates.clear();
+  if(fTrackEta.empty()) return fPairCandidates;
+
+  // Directions outside of the eta range of the tracks can only be close to the tracks in the edge cells
+  const Int_t etaCell = std::max(0, std::min(fnEtaCells-1, (Int_t)TMath::Floor((eta - fMinEta) / fEtaCellSize)));
+  CollectNeighbourCells(etaCell, GetPhiCell(phi), 0);
+
+  // Give the tracks in the same order as in the full track list
+  std::sort(fPairCandidates.begin(), fPairCandidates.end());
+  return fPairCandidates;
+}
+
+/*
+ * Collect the tracks from the same and adjacent cells as the given one to the candidate buffer
+ *
+ *  Arguments:
+ *   const Int_t etaCell = Eta index of the cell
+ *   const Int_t phiCell = Phi index of the cell
+ *   const Int_t minTrack = Only the tracks with index at least this are collected
+ */
+void TrackPairGrid::CollectNeighbourCells(const Int_t etaCell, const Int_t phiCell, const Int_t minTrack){
+
+  // With less than three phi cells, the neighbouring cells on both sides are the same
+  const Int_t firstPhiShift = fnPhiCells < 3 ? 0 : -1;
+  const Int_t lastPhiShift = fnPhiCells < 2 ? 0 : 1;
+
+  // The tracks are in increasing order inside the cells, so the collected tracks are the tail of each cell
+  Int_t cell;
+  const Int_t *firstTrack, *lastTrack;
+  for(Int_t iEta = std::max(0, etaCell-1); iEta <= std::min(fnEtaCells-1, etaCell+1); iEta++){
+    for(Int_t phiShift = firstPhiShift; phiShift <= lastPhiShift; phiShift++){
+      cell = iEta*fnPhiCells + (phiCell + phiShift + fnPhiCells) % fnPhiCells;
+      lastTrack = fCellTracks.data() + fCellStart[cell+1];
+      firstTrack = std::lower_bound(GetCellTracks(cell), lastTrack, minTrack);
+      fPairCandidates.insert(fPairCandidates.end(), firstTrack, lastTrack);
+    }
+  }
+}
+
+// Getter for the number of cells in the grid
+Int_t TrackPairGrid::GetNCells() const{
+  return fnEtaCells*fnPhiCells;
+}
+
+// Getter for the indices of the tracks in a cell. The indices are in increasing order.
+const Int_t* TrackPairGrid::GetCellTracks(const Int_t iCell) const{
+  return fCellTracks.data() + fCellStart[iCell];
+}
+
+// Getter for the number of tracks in a cell
+Int_t TrackPairGrid::GetNCellTracks(const Int_t iCell) const{
+  return fCellStart[iCell+1] - fCellStart[iCell];
+}
+
+/*
+ * Find the eta index of a cell
+ *
+ *  Arguments:
+ *   const Double_t eta = Eta of the track
+ *
+ *   return: Eta index of the cell containing the track
+ */
+Int_t TrackPairGrid::GetEtaCell(const Double_t eta) const{
+  const Int_t etaCell = (Int_t)((eta - fMinEta) / fEtaCellSize);
+  return std::min(etaCell, fnEtaCells-1); // The track with the largest eta is on the upper edge
+}
+
+/*
+ * Find the phi index of a cell
+ *
+ *  Arguments:
+ *   const Double_t phi = Phi of the track. Does not need to be inside [-pi,pi].
+ *
+ *   return: Phi index of the cell containing the track
+ */
+Int_t TrackPairGrid::GetPhiCell(const Double_t phi) const{
+
+  // Transform phi to interval [0,2pi]
+  Double_t shiftedPhi = phi + TMath::Pi();
+  while(shiftedPhi >= 2*TMath::Pi()){shiftedPhi += -2*TMath::Pi();}
+  while(shiftedPhi < 0){shiftedPhi += 2*TMath::Pi();}
+
+  return std::min((Int_t)(shiftedPhi / fPhiCellSize), fnPhiCells-1);
+}
@@ -0,0 +1,70 @@
+// Class for finding track pairs close to each other in the eta-phi plane
+//
+//===========================================================
+// TrackPairGrid.h
+//
+// The tracks of one event are sorted to a grid of cells in the eta-phi plane. The cells are at least as large
+// as the maximum distance of the pairs in both directions, such that all the pairs within the maximum
+// distance are found from the same or adjacent cells. The phi direction wraps around. Inside each cell the
+// tracks are kept in increasing index order, such that the candidates with larger index than a given track
+// are found as the tail of each cell without sorting. In the same way, the tracks closer than the maximum
+// distance to any direction, like a jet axis, are found from the cells around that direction.
+//===========================================================
+
+#ifndef TRACKPAIRGRID_H
+#define TRACKPAIRGRID_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+// Root includes
+#include <TMath.h>
+
+using namespace std;
+
+class TrackPairGrid{
+
+public:
+
+  // Constructors and destructor
+  TrackPairGrid();                                  // Default constructor
+  TrackPairGrid(const Double_t maxDeltaR);          // Custom constructor
+  TrackPairGrid(const TrackPairGrid& in);           // Copy constructor
+  ~TrackPairGrid();                                 // Destructor
+  TrackPairGrid& operator=(const TrackPairGrid& obj); // Equal sign operator
+
+  // Methods
+  void Clear();                                     // Remove all the tracks from the grid
+  void AddTrack(const Double_t eta, const Double_t phi); // Add a track to the grid
+  void Build();                                     // Sort the added tracks to the cells
+  const std::vector<Int_t>& FindPairCandidates(const Int_t iTrack); // Find the tracks after the given one in the same or adjacent cells
+  const std::vector<Int_t>& FindConeCandidates(const Double_t eta, const Double_t phi); // Find the tracks in the cells around a given direction
+  Int_t GetNCells() const;                          // Getter for the number of cells in the grid
+  const Int_t* GetCellTracks(const Int_t iCell) const; // Getter for the indices of the tracks in a cell
+  Int_t GetNCellTracks(const Int_t iCell) const;    // Getter for the number of tracks in a cell
+
+private:
+
+  Int_t GetEtaCell(const Double_t eta) const;       // Find the eta index of a cell
+  Int_t GetPhiCell(const Double_t phi) const;       // Find the phi index of a cell
+  void CollectNeighbourCells(const Int_t etaCell, const Int_t phiCell, const Int_t minTrack); // Collect the tracks from the same and adjacent cells
+
+  Double_t fMaxDeltaR;                // Maximum distance of the pairs. Defines the minimum cell size.
+  Int_t fnEtaCells;                   // Number of cells in eta direction
+  Int_t fnPhiCells;                   // Number of cells in phi direction
+  Double_t fMinEta;                   // Lower edge of the grid in eta
+  Double_t fEtaCellSize;              // Size of the cells in eta direction
+  Double_t fPhiCellSize;              // Size of the cells in phi direction
+  std::vector<Double_t> fTrackEta;    // Eta of the added tracks
+  std::vector<Double_t> fTrackPhi;    // Phi of the added tracks
+  std::vector<Int_t> fTrackCell;      // Cell index of each track
+  std::vector<Int_t> fCellStart;      // Position of the first track of each cell in fCellTracks. Last element is the number of tracks.
+  std::vector<Int_t> fCellTracks;     // Track indices ordered by cell. Increasing order inside each cell.
+  std::vector<Int_t> fPairCandidates; // Buffer for the pair or cone candidates
+
+};
+
+#endif
@@ -0,0 +1,262 @@
+// Implementation of the kernel selecting the close track pairs
+
+// C++ includes
+#if defined(__x86_64__) || defined(__i386__)
+#define TRACKPAIRKERNEL_X86
+#include <immintrin.h>
+#endif
+
+// Own includes
+#include "TrackPairKernel.h"
+
+/*
+ * Default constructor
+ */
+TrackPairKernel::TrackPairKernel() :
+  fMaxDeltaR(0.8),
+  fPreselectionDeltaRSquared(0),
+  fImplementation(kScalar),
+  fSurvivors(),
+  fAcceptedPartner(),
+  fAcceptedDeltaR(),
+  fAcceptedAveragePhi()
+{
+  // Default constructor
+  fPreselectionDeltaRSquared = fMaxDeltaR*fMaxDeltaR + 1e-4;
+  fImplementation = FindImplementation();
+}
+
+/*
+ * Custom constructor
+ *
+ *  Arguments:
+ *   const Double_t maxDeltaR = Maximum DeltaR for the accepted pairs
+ */
+TrackPairKernel::TrackPairKernel(const Double_t maxDeltaR) :
+  fMaxDeltaR(maxDeltaR),
+  fPreselectionDeltaRSquared(0),
+  fImplementation(kScalar),
+  fSurvivors(),
+  fAcceptedPartner(),
+  fAcceptedDeltaR(),
+  fAcceptedAveragePhi()
+{
+  // Custom constructor
+
+  // The margin covers the rounding in the single precision preselection
+  fPreselectionDeltaRSquared = fMaxDeltaR*fMaxDeltaR + 1e-4;
+  fImplementation = FindImplementation();
+}
+
+/*
+ * Copy constructor
+ */
+TrackPairKernel::TrackPairKernel(const TrackPairKernel& in) :
+  fMaxDeltaR(in.fMaxDeltaR),
+  fPreselectionDeltaRSquared(in.fPreselectionDeltaRSquared),
+  fImplementation(in.fImplementation),
+  fSurvivors(),
+  fAcceptedPartner(in.fAcceptedPartner),
+  fAcceptedDeltaR(in.fAcceptedDeltaR),
+  fAcceptedAveragePhi(in.fAcceptedAveragePhi)
+{
+  // Copy constructor
+}
+
+/*
+ * Destructor
+ */
+TrackPairKernel::~TrackPairKernel(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+TrackPairKernel& TrackPairKernel::operator=(const TrackPairKernel& in){
+  if(&in == this) return *this;
+
+  fMaxDeltaR = in.fMaxDeltaR;
+  fPreselectionDeltaRSquared = in.fPreselectionDeltaRSquared;
+  fImplementation = in.fImplementation;
+  fSurvivors.clear();
+  fAcceptedPartner = in.fAcceptedPartner;
+  fAcceptedDeltaR = in.fAcceptedDeltaR;
+  fAcceptedAveragePhi = in.fAcceptedAveragePhi;
+
+  return *this;
+}
+
+/*
+ * Select the partners closer than the maximum DeltaR to the trigger track
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &tracks = Buffer containing the trigger and the partner tracks
+ *   const Int_t iTrigger = Index of the trigger track in the buffer
+ *   const std::vector<Int_t> &partners = Indices of the partner tracks in the buffer
+ *
+ *   return: Number of accepted pairs. The accepted pairs are in the same order as the partners.
+ */
+Int_t TrackPairKernel::FindClosePairs(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const std::vector<Int_t> &partners){
+  return FindClosePairs(tracks, iTrigger, partners.data(), partners.size());
+}
+
+/*
+ * Select the partners closer than the maximum DeltaR to the trigger track
+ *
+ *  Arguments:
+ *   const SelectedTrackBuffer &tracks = Buffer containing the trigger and the partner tracks
+ *   const Int_t iTrigger = Index of the trigger track in the buffer
+ *   const Int_t *partners = Array of indices of the partner tracks in the buffer
+ *   const Int_t nPartners = Number of partner tracks
+ *
+ *   return: Number of accepted pairs. The accepted pairs are in the same order as the partners.
+ */
+Int_t TrackPairKernel::FindClosePairs(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const Int_t *partners, const Int_t nPartners){
+
+  const Float_t *eta = tracks.GetEtaArray();
+  const Float_t *phi = tracks.GetPhiArray();
+
+  // Preselect the pairs in single precision
+  if((Int_t)fSurvivors.size() < nPartners) fSurvivors.resize(nPartners);
+  Int_t nSurvivors;
+  if(fImplementation == kAvx2){
+    nSurvivors = PreselectAvx2(eta[iTrigger], phi[iTrigger], eta, phi, partners, nPartners, fPreselectionDeltaRSquared, fSurvivors.data());
+  } else {
+    nSurvivors = PreselectScalar(eta[iTrigger], phi[iTrigger], eta, phi, partners, nPartners, fPreselectionDeltaRSquared, fSurvivors.data());
+  }
+
+  if((Int_t)fAcceptedPartner.size() < nSurvivors){
+    fAcceptedPartner.resize(nSurvivors);
+    fAcceptedDeltaR.resize(nSurvivors);
+    fAcceptedAveragePhi.resize(nSurvivors);
+  }
+
+  // Calculate DeltaR and average phi for the survivors in double precision. The operations are the same
+  // as in GetDeltaR and GetAveragePhi of the analyzer, written without branches.
+  const Double_t triggerEta = eta[iTrigger];
+  const Double_t triggerPhi = phi[iTrigger];
+  Double_t partnerPhi, deltaEta, deltaPhi, deltaR, phiSum;
+  Int_t nAccepted = 0;
+  for(Int_t iSurvivor = 0; iSurvivor < nSurvivors; iSurvivor++){
+    partnerPhi = phi[fSurvivors[iSurvivor]];
+    deltaEta = triggerEta - eta[fSurvivors[iSurvivor]];
+    deltaPhi = triggerPhi - partnerPhi;
+
+    // Transform deltaPhi to interval [-pi,pi]
+    deltaPhi += (deltaPhi > TMath::Pi()) ? -2*TMath::Pi() : 0;
+    deltaPhi += (deltaPhi < -TMath::Pi()) ? 2*TMath::Pi() : 0;
+    deltaR = std::sqrt(deltaPhi*deltaPhi + deltaEta*deltaEta);
+
+    // When the tracks are on different sides of the phi = pi line, the average is rotated by pi
+    phiSum = triggerPhi + partnerPhi;
+    fAcceptedAveragePhi[nAccepted] = (phiSum/2.0) + ((std::fabs(triggerPhi - partnerPhi) > TMath::Pi()) ? ((phiSum > 0) ? -TMath::Pi() : TMath::Pi()) : 0);
+    fAcceptedDeltaR[nAccepted] = deltaR;
+    fAcceptedPartner[nAccepted] = fSurvivors[iSurvivor];
+    nAccepted += (deltaR < fMaxDeltaR);
+  }
+
+  return nAccepted;
+}
+
+// Getter for the implementation used for the preselection
+Int_t TrackPairKernel::GetImplementation() const{
+  return fImplementation;
+}
+
+// Getter for the name of the implementation used for the preselection
+const char* TrackPairKernel::GetImplementationName() const{
+  const char* implementationName[knImplementations] = {"scalar", "AVX2"};
+  return implementationName[fImplementation];
+}
+
+/*
+ * Find the fastest implementation supported by the processor running the analysis
+ *
+ *   return: Implementation used for the preselection
+ */
+Int_t TrackPairKernel::FindImplementation(){
+#ifdef TRACKPAIRKERNEL_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2")) return kAvx2;
+#endif
+  return kScalar;
+}
+
+/*
+ * Preselect the partners without vector instructions
+ *
+ *  Arguments:
+ *   const Float_t triggerEta = Eta of the trigger track
+ *   const Float_t triggerPhi = Phi of the trigger track
+ *   const Float_t *eta = Eta of all the tracks
+ *   const Float_t *phi = Phi of all the tracks
+ *   const Int_t *partners = Indices of the partner tracks
+ *   const Int_t nPartners = Number of partner tracks
+ *   const Float_t maxDeltaRSquared = Squared DeltaR cut
+ *   Int_t *survivors = Array to which the indices of the partners passing the cut are written
+ *
+ *   return: Number of partners passing the cut
+ */
+Int_t TrackPairKernel::PreselectScalar(const Float_t triggerEta, const Float_t triggerPhi, const Float_t *eta, const Float_t *phi, const Int_t *partners, const Int_t nPartners, const Float_t maxDeltaRSquared, Int_t *survivors){
+
+  const Float_t twoPi = 2*TMath::Pi();
+  Float_t deltaEta, deltaPhi;
+  Int_t nSurvivors = 0;
+  for(Int_t iPartner = 0; iPartner < nPartners; iPartner++){
+    deltaEta = triggerEta - eta[partners[iPartner]];
+    deltaPhi = std::fabs(triggerPhi - phi[partners[iPartner]]);
+    deltaPhi = std::min(deltaPhi, twoPi - deltaPhi);
+
+    // The index is always written, but the counter is only moved for the survivors
+    survivors[nSurvivors] = partners[iPartner];
+    nSurvivors += (deltaEta*deltaEta + deltaPhi*deltaPhi < maxDeltaRSquared);
+  }
+  return nSurvivors;
+}
+
+/*
+ * Preselect the partners eight at a time with AVX2 instructions. The arguments are the same as for PreselectScalar.
+ * Only called if the processor supports AVX2, so the instructions are enabled only for this function.
+ */
+#ifdef TRACKPAIRKERNEL_X86
+__attribute__((target("avx2")))
+Int_t TrackPairKernel::PreselectAvx2(const Float_t triggerEta, const Float_t triggerPhi, const Float_t *eta, const Float_t *phi, const Int_t *partners, const Int_t nPartners, const Float_t maxDeltaRSquared, Int_t *survivors){
+
+  const __m256 triggerEtaVector = _mm256_set1_ps(triggerEta);
+  const __m256 triggerPhiVector = _mm256_set1_ps(triggerPhi);
+  const __m256 twoPiVector = _mm256_set1_ps(2*TMath::Pi());
+  const __m256 maxDeltaRSquaredVector = _mm256_set1_ps(maxDeltaRSquared);
+  const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+  __m256i partnerVector;
+  __m256 deltaEta, deltaPhi, deltaRSquared;
+  Int_t passMask;
+  Int_t nSurvivors = 0;
+  Int_t iPartner = 0;
+  for(; iPartner + 8 <= nPartners; iPartner += 8){
+
+    // Gather the eta and phi of the next eight partners
+    partnerVector = _mm256_loadu_si256((const __m256i*)(partners + iPartner));
+    deltaEta = _mm256_sub_ps(triggerEtaVector, _mm256_i32gather_ps(eta, partnerVector, 4));
+    deltaPhi = _mm256_and_ps(_mm256_sub_ps(triggerPhiVector, _mm256_i32gather_ps(phi, partnerVector, 4)), signMask);
+    deltaPhi = _mm256_min_ps(deltaPhi, _mm256_sub_ps(twoPiVector, deltaPhi));
+
+    deltaRSquared = _mm256_add_ps(_mm256_mul_ps(deltaEta, deltaEta), _mm256_mul_ps(deltaPhi, deltaPhi));
+    passMask = _mm256_movemask_ps(_mm256_cmp_ps(deltaRSquared, maxDeltaRSquaredVector, _CMP_LT_OQ));
+
+    // Write the survivors in the original order
+    while(passMask){
+      survivors[nSurvivors++] = partners[iPartner + __builtin_ctz(passMask)];
+      passMask &= passMask - 1;
+    }
+  }
+
+  // The last partners that do not fill a full vector
+  return nSurvivors + PreselectScalar(triggerEta, triggerPhi, eta, phi, partners + iPartner, nPartners - iPartner, maxDeltaRSquared, survivors + nSurvivors);
+}
+#else
+Int_t TrackPairKernel::PreselectAvx2(const Float_t triggerEta, const Float_t triggerPhi, const Float_t *eta, const Float_t *phi, const Int_t *partners, const Int_t nPartners, const Float_t maxDeltaRSquared, Int_t *survivors){
+  return PreselectScalar(triggerEta, triggerPhi, eta, phi, partners, nPartners, maxDeltaRSquared, survivors);
+}
+#endif
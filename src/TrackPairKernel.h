@@ -0,0 +1,73 @@
+// Kernel for selecting the close track pairs for one trigger track
+//
+//===========================================================
+// TrackPairKernel.h
+//
+// The pair selection is done in two steps. First, the squared DeltaR between the trigger track and a block of
+// partner tracks is calculated in single precision without branches or square roots, using AVX2 instructions
+// when the processor supports them. Only a small safety margin is added to the 0.8 cut, such that rounding can
+// not remove any pair. For the partners surviving this preselection, DeltaR and the average phi are calculated
+// in double precision with the same operations as GetDeltaR and GetAveragePhi in the analyzer, such that the
+// accepted pairs and the filled values are exactly the same as when looping over all the pairs. The phi values
+// are assumed to be in the interval [-pi,pi] as given by the forests.
+//===========================================================
+
+#ifndef TRACKPAIRKERNEL_H
+#define TRACKPAIRKERNEL_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <assert.h>
+
+// Root includes
+#include <TMath.h>
+
+// Own includes
+#include "SelectedTrackBuffer.h"
+
+using namespace std;
+
+class TrackPairKernel{
+
+public:
+
+  // Implementations of the preselection
+  enum enumImplementations{kScalar, kAvx2, knImplementations};
+
+  // Constructors and destructor
+  TrackPairKernel();                                    // Default constructor
+  TrackPairKernel(const Double_t maxDeltaR);            // Custom constructor
+  TrackPairKernel(const TrackPairKernel& in);           // Copy constructor
+  ~TrackPairKernel();                                   // Destructor
+  TrackPairKernel& operator=(const TrackPairKernel& obj); // Equal sign operator
+
+  // Methods
+  Int_t FindClosePairs(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const std::vector<Int_t> &partners); // Select the partners closer than the maximum DeltaR to the trigger
+  Int_t FindClosePairs(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const Int_t *partners, const Int_t nPartners); // Select the partners from an array of indices
+  Int_t GetImplementation() const;               // Getter for the implementation used for the preselection
+  const char* GetImplementationName() const;     // Getter for the name of the implementation used for the preselection
+
+  // Getters for the accepted pairs. Defined here, since these are called in the pair loops.
+  Int_t GetPartner(const Int_t iPair) const{return fAcceptedPartner[iPair];}         // Getter for the index of the partner track
+  Double_t GetDeltaR(const Int_t iPair) const{return fAcceptedDeltaR[iPair];}        // Getter for DeltaR between the tracks
+  Double_t GetAveragePhi(const Int_t iPair) const{return fAcceptedAveragePhi[iPair];} // Getter for the average phi of the tracks
+
+private:
+
+  static Int_t FindImplementation(); // Find the fastest implementation supported by the processor
+  static Int_t PreselectScalar(const Float_t triggerEta, const Float_t triggerPhi, const Float_t *eta, const Float_t *phi, const Int_t *partners, const Int_t nPartners, const Float_t maxDeltaRSquared, Int_t *survivors); // Preselect the partners without vector instructions
+  static Int_t PreselectAvx2(const Float_t triggerEta, const Float_t triggerPhi, const Float_t *eta, const Float_t *phi, const Int_t *partners, const Int_t nPartners, const Float_t maxDeltaRSquared, Int_t *survivors);   // Preselect the partners eight at a time with AVX2 instructions
+
+  Double_t fMaxDeltaR;                        // Maximum DeltaR for the accepted pairs
+  Float_t fPreselectionDeltaRSquared;         // Squared DeltaR cut with a safety margin for the single precision preselection
+  Int_t fImplementation;                      // Implementation used for the preselection
+  std::vector<Int_t> fSurvivors;              // Partners surviving the preselection
+  std::vector<Int_t> fAcceptedPartner;        // Partners of the accepted pairs
+  std::vector<Double_t> fAcceptedDeltaR;      // DeltaR of the accepted pairs
+  std::vector<Double_t> fAcceptedAveragePhi;  // Average phi of the accepted pairs
+
+};
+
+#endif
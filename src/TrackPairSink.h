@@ -0,0 +1,343 @@
+// Class for filling the track pairs found by the pair engine to a histogram
+//
+//===========================================================
+// TrackPairSink.h
+//
+// The axis layout of the filled histogram is given as a template argument. The layout tells which axes depend
+// on the track pair and how their coordinates are calculated. These axes are always the first ones in the
+// histogram. The remaining axes, like centrality or jet pT, are constant for all the pairs of an event or
+// a jet. Their bin indices are found once when the values are bound to the sink, so that the pair loop only
+// needs to find the bins for the pair dependent axes. The pairs are filled with the weight
+// efficiency(trigger) * efficiency(partner) * event weight.
+//
+// The pairs are not filled one by one. Their coordinates and weights are collected to a fixed size buffer,
+// which is flushed to the histogram when it is full or when the bin of a bound axis changes. In a flush, the
+// bins are found one axis at a time over all the buffered pairs, and the bound axes only add one constant
+// offset to the linear bin index. The buffer must be flushed before the histogram is used.
+//
+// The pairs can also be filled to a THnSparseF, which is used when the binning is too large to keep all the bins
+// in memory. The bins are then found in the same way with AxisBinners made from the axes of the sparse histogram,
+// and the sparse histogram is only asked for the linear bin of the bin indices of each pair.
+//===========================================================
+
+#ifndef TRACKPAIRSINK_H
+#define TRACKPAIRSINK_H
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+// Own includes
+#include "DenseHistogram.h"
+#include "SelectedTrackBuffer.h"
+#include "TrackPairEngine.h"
+
+using namespace std;
+
+/*
+ * Axis layout of the inclusive track pair histograms
+ */
+struct InclusivePairAxes{
+
+  enum enumAxes{kDeltaR, kLeadingPt, kSubleadingPt, kAveragePhi, kAverageEta, kCentrality, knAxes};
+  static const Int_t knPairAxes = 5; // The axes before kCentrality depend on the pair
+
+  // Coordinates of the pair dependent axes
+  static void GetPairCoordinates(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const Int_t iPartner, const Double_t deltaR, const Double_t averagePhi, Double_t *coordinates){
+    coordinates[kDeltaR] = deltaR;                                                    // Axis 0: DeltaR between the two tracks
+    coordinates[kLeadingPt] = tracks.GetPt(iTrigger);                                 // Axis 1: Higher track pT
+    coordinates[kSubleadingPt] = tracks.GetPt(iPartner);                              // Axis 2: Lower track pT
+    coordinates[kAveragePhi] = averagePhi;                                            // Axis 3: Average pair phi
+    coordinates[kAverageEta] = (tracks.GetEta(iTrigger)+tracks.GetEta(iPartner))/2.0; // Axis 4: Average pair eta
+  }
+};
+
+/*
+ * Axis layout of the histograms for track pairs close to jets
+ */
+struct JetConePairAxes{
+
+  enum enumAxes{kDeltaR, kLeadingPt, kSubleadingPt, kJetPt, kDataLevel, kCentrality, knAxes};
+  static const Int_t knPairAxes = 3; // The axes before kJetPt depend on the pair
+
+  // Coordinates of the pair dependent axes
+  static void GetPairCoordinates(const SelectedTrackBuffer &tracks, const Int_t iTrigger, const Int_t iPartner, const Double_t deltaR, const Double_t averagePhi, Double_t *coordinates){
+    coordinates[kDeltaR] = deltaR;                       // Axis 0: DeltaR between the two tracks
+    coordinates[kLeadingPt] = tracks.GetPt(iTrigger);    // Axis 1: Higher particle pT
+    coordinates[kSubleadingPt] = tracks.GetPt(iPartner); // Axis 2: Lower particle pT
+  }
+};
+
+template <class AxisLayout>
+class TrackPairSink{
+
+public:
+
+  // Constructors and destructor
+  TrackPairSink();                                    // Default constructor
+  TrackPairSink(const TrackPairSink& in);             // Copy constructor
+  ~TrackPairSink();                                   // Destructor
+  TrackPairSink& operator=(const TrackPairSink& obj); // Equal sign operator
+
+  // Setters
+  void SetHistogram(DenseHistogram *histogram);        // Setter for the filled histogram
+  void SetHistogram(THnSparseF *histogram);            // Setter for the filled histogram with sparse bins
+  void BindAxis(const Int_t iAxis, const Double_t value); // Setter for the value of an axis that is the same for all the pairs
+  void SetWeight(const Double_t weight);               // Setter for the event weight
+
+  // Methods
+  void FillPairs(TrackPairEngine &pairEngine, const SelectedTrackBuffer &tracks); // Fill all the pairs found by the engine
+  void Flush();                                        // Fill the buffered pairs to the histogram
+
+private:
+
+  static const Int_t fBufferSize = 4096;       // Maximum number of pairs in the buffer
+
+  DenseHistogram *fHistogram;                  // Filled histogram. Null if the pairs are filled to a sparse histogram.
+  THnSparseF *fSparseHistogram;                // Filled sparse histogram. Null if the pairs are filled to a dense histogram.
+  const AxisBinner *fAxisBinners[AxisLayout::knAxes]; // Bin search for the axes of the filled histogram
+  AxisBinner fSparseAxisBinners[AxisLayout::knAxes];  // Bin search for the axes of the sparse histogram
+  Int_t fBinIndex[AxisLayout::knAxes];         // Bin indices of the bound axes. The pair dependent axes are kept at zero.
+  Double_t fWeight;                            // Event weight
+  Int_t fnBufferedPairs;                       // Number of pairs in the buffer
+  std::vector<Double_t> fPairCoordinates;      // Coordinates of the pair dependent axes for the buffered pairs, one pair after another
+  std::vector<Double_t> fPairWeights;          // Weights of the buffered pairs
+  std::vector<Long64_t> fPairBins;             // Linear bin indices of the buffered pairs, found in the flush
+  std::vector<Int_t> fPairAxisBins;            // Bin indices of the pair dependent axes for the sparse histogram, found in the flush
+
+};
+
+/*
+ * Default constructor
+ */
+template <class AxisLayout>
+TrackPairSink<AxisLayout>::TrackPairSink() :
+  fHistogram(0),
+  fSparseHistogram(0),
+  fWeight(1),
+  fnBufferedPairs(0),
+  fPairCoordinates(fBufferSize*AxisLayout::knPairAxes),
+  fPairWeights(fBufferSize),
+  fPairBins(fBufferSize),
+  fPairAxisBins(fBufferSize*AxisLayout::knPairAxes)
+{
+  // Default constructor
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knAxes; iAxis++){
+    fAxisBinners[iAxis] = 0;
+    fBinIndex[iAxis] = 0;
+  }
+}
+
+/*
+ * Copy constructor. The buffered pairs are not copied, since they belong to the original sink. For a sparse
+ * histogram, the bin search points to the own copies of the axis binners.
+ */
+template <class AxisLayout>
+TrackPairSink<AxisLayout>::TrackPairSink(const TrackPairSink& in) :
+  fHistogram(in.fHistogram),
+  fSparseHistogram(in.fSparseHistogram),
+  fWeight(in.fWeight),
+  fnBufferedPairs(0),
+  fPairCoordinates(fBufferSize*AxisLayout::knPairAxes),
+  fPairWeights(fBufferSize),
+  fPairBins(fBufferSize),
+  fPairAxisBins(fBufferSize*AxisLayout::knPairAxes)
+{
+  // Copy constructor
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knAxes; iAxis++){
+    fSparseAxisBinners[iAxis] = in.fSparseAxisBinners[iAxis];
+    fAxisBinners[iAxis] = fSparseHistogram ? &fSparseAxisBinners[iAxis] : in.fAxisBinners[iAxis];
+    fBinIndex[iAxis] = in.fBinIndex[iAxis];
+  }
+}
+
+/*
+ * Destructor
+ */
+template <class AxisLayout>
+TrackPairSink<AxisLayout>::~TrackPairSink(){
+  // Destructor
+}
+
+/*
+ * Equal sign operator
+ */
+template <class AxisLayout>
+TrackPairSink<AxisLayout>& TrackPairSink<AxisLayout>::operator=(const TrackPairSink& in){
+  if(&in == this) return *this;
+
+  fHistogram = in.fHistogram;
+  fSparseHistogram = in.fSparseHistogram;
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knAxes; iAxis++){
+    fSparseAxisBinners[iAxis] = in.fSparseAxisBinners[iAxis];
+    fAxisBinners[iAxis] = fSparseHistogram ? &fSparseAxisBinners[iAxis] : in.fAxisBinners[iAxis];
+    fBinIndex[iAxis] = in.fBinIndex[iAxis];
+  }
+  fWeight = in.fWeight;
+  fnBufferedPairs = 0;
+
+  return *this;
+}
+
+/*
+ * Setter for the filled histogram. The histogram must have the axes given by the layout.
+ *
+ *  Arguments:
+ *   DenseHistogram *histogram = Histogram to which the pairs are filled
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::SetHistogram(DenseHistogram *histogram){
+  if(histogram->GetNdimensions() != AxisLayout::knAxes){
+    cout << "Error! The pair histogram has " << histogram->GetNdimensions() << " axes, but " << AxisLayout::knAxes << " are needed" << endl;
+    assert(0);
+  }
+
+  if(fnBufferedPairs > 0){
+    cout << "Error! The pair sink must be flushed before changing the histogram" << endl;
+    assert(0);
+  }
+
+  fHistogram = histogram;
+  fSparseHistogram = 0;
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knAxes; iAxis++){
+    fAxisBinners[iAxis] = histogram->GetAxisBinner(iAxis);
+  }
+}
+
+/*
+ * Setter for the filled histogram with sparse bins. The histogram must have the axes given by the layout.
+ * The bin search is prepared here from the axes of the sparse histogram.
+ *
+ *  Arguments:
+ *   THnSparseF *histogram = Histogram to which the pairs are filled
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::SetHistogram(THnSparseF *histogram){
+  if(histogram->GetNdimensions() != AxisLayout::knAxes){
+    cout << "Error! The pair histogram has " << histogram->GetNdimensions() << " axes, but " << AxisLayout::knAxes << " are needed" << endl;
+    assert(0);
+  }
+
+  if(fnBufferedPairs > 0){
+    cout << "Error! The pair sink must be flushed before changing the histogram" << endl;
+    assert(0);
+  }
+
+  fHistogram = 0;
+  fSparseHistogram = histogram;
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knAxes; iAxis++){
+    fSparseAxisBinners[iAxis].SetBins(histogram->GetAxis(iAxis));
+    fAxisBinners[iAxis] = &fSparseAxisBinners[iAxis];
+  }
+}
+
+/*
+ * Setter for the value of an axis that is the same for all the pairs. The bin is found here once. If the bin
+ * changes, the pairs already in the buffer are flushed with the old bin.
+ *
+ *  Arguments:
+ *   const Int_t iAxis = Index of the bound axis. Must not be one of the pair dependent axes.
+ *   const Double_t value = Value for the axis
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::BindAxis(const Int_t iAxis, const Double_t value){
+  if(iAxis < AxisLayout::knPairAxes || iAxis >= AxisLayout::knAxes){
+    cout << "Error! Axis " << iAxis << " can not be bound in the pair sink" << endl;
+    assert(0);
+  }
+  const Int_t binIndex = fAxisBinners[iAxis]->FindBin(value);
+  if(binIndex == fBinIndex[iAxis]) return;
+  Flush();
+  fBinIndex[iAxis] = binIndex;
+}
+
+/*
+ * Setter for the event weight
+ *
+ *  Arguments:
+ *   const Double_t weight = Weight for the event, multiplied by the track efficiencies for each pair
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::SetWeight(const Double_t weight){
+  fWeight = weight;
+}
+
+/*
+ * Fill all the pairs found by the engine. The tracks must be set to the engine before calling this.
+ * The pairs are collected to the buffer, and flushed to the histogram whenever the buffer is full.
+ *
+ *  Arguments:
+ *   TrackPairEngine &pairEngine = Engine finding the pairs
+ *   const SelectedTrackBuffer &tracks = Track table given to the engine
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::FillPairs(TrackPairEngine &pairEngine, const SelectedTrackBuffer &tracks){
+
+  Int_t iTrigger, iPartner;
+  while(pairEngine.FindNextPairs()){
+    iTrigger = pairEngine.GetTrigger();
+    for(Int_t iPair = 0; iPair < pairEngine.GetNPairs(); iPair++){
+      if(fnBufferedPairs == fBufferSize) Flush();
+      iPartner = pairEngine.GetPartner(iPair);
+      AxisLayout::GetPairCoordinates(tracks, iTrigger, iPartner, pairEngine.GetDeltaR(iPair), pairEngine.GetAveragePhi(iPair), &fPairCoordinates[fnBufferedPairs*AxisLayout::knPairAxes]);
+      fPairWeights[fnBufferedPairs] = tracks.GetEfficiency(iTrigger) * tracks.GetEfficiency(iPartner) * fWeight;
+      fnBufferedPairs++;
+    }
+  }
+}
+
+/*
+ * Fill the buffered pairs to the histogram. The bound axes give a constant offset to the linear bin index,
+ * and the bins of the pair dependent axes are found one axis at a time for all the pairs.
+ */
+template <class AxisLayout>
+void TrackPairSink<AxisLayout>::Flush(){
+
+  if(fnBufferedPairs == 0) return;
+
+  // For a sparse histogram, the bins of the pair dependent axes are found one axis at a time as for the dense histogram.
+  // The sparse histogram only gives the linear bin for the bin indices, allocating it if the bin is not filled yet.
+  if(fSparseHistogram){
+    for(Int_t iAxis = 0; iAxis < AxisLayout::knPairAxes; iAxis++){
+      for(Int_t iPair = 0; iPair < fnBufferedPairs; iPair++){
+        fPairAxisBins[iPair*AxisLayout::knPairAxes + iAxis] = fAxisBinners[iAxis]->FindBin(fPairCoordinates[iPair*AxisLayout::knPairAxes + iAxis]);
+      }
+    }
+
+    // FillBin adds the weight to the bin content and the squared weight to the bin error, and counts the entry
+    Int_t binIndex[AxisLayout::knAxes];
+    std::copy(fBinIndex, fBinIndex + AxisLayout::knAxes, binIndex);
+    for(Int_t iPair = 0; iPair < fnBufferedPairs; iPair++){
+      std::copy(&fPairAxisBins[iPair*AxisLayout::knPairAxes], &fPairAxisBins[(iPair+1)*AxisLayout::knPairAxes], binIndex);
+      fSparseHistogram->FillBin(fSparseHistogram->GetBin(binIndex, kTRUE), fPairWeights[iPair]);
+    }
+    fnBufferedPairs = 0;
+    return;
+  }
+
+  // The bin indices of the pair dependent axes are kept at zero, so this gives the offset from the bound axes
+  const Long64_t boundAxisOffset = fHistogram->GetBin(fBinIndex);
+  for(Int_t iPair = 0; iPair < fnBufferedPairs; iPair++){
+    fPairBins[iPair] = boundAxisOffset;
+  }
+
+  // Find the bins one axis at a time
+  Long64_t binStride;
+  for(Int_t iAxis = 0; iAxis < AxisLayout::knPairAxes; iAxis++){
+    binStride = fHistogram->GetBinStride(iAxis);
+    for(Int_t iPair = 0; iPair < fnBufferedPairs; iPair++){
+      fPairBins[iPair] += fAxisBinners[iAxis]->FindBin(fPairCoordinates[iPair*AxisLayout::knPairAxes + iAxis]) * binStride;
+    }
+  }
+
+  // Fill the pairs in the same order as they were found
+  for(Int_t iPair = 0; iPair < fnBufferedPairs; iPair++){
+    fHistogram->FillBin(fPairBins[iPair], fPairWeights[iPair]);
+  }
+
+  fnBufferedPairs = 0;
+}
+
+#endif